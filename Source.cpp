@@ -6,9 +6,47 @@
 #include <vector>
 #include <ctime>
 #include <cstdlib>
+#include <new>
 #include <cmath>
 #include <algorithm>  
 #include <random> 
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <iomanip>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <variant>
+#include <array>
+#include <memory_resource>
+#include <charconv>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -22,1724 +60,5478 @@ enum class GameState {
     HighScore
 };
 
-//---------------------------------- Invader ----------------------------------
-class Invader {
-protected:
-    sf::Sprite sprite;
-    sf::Vector2f targetPos;
-    float speed = 100.f;
-    bool aligned = false;
-
-    int health = 1;
+//---------------------------------- TickInput ----------------------------------
+// Fixed simulation rate; every timer and speed is expressed against it.
+constexpr int SimTickRate = 120;
+constexpr float SimTickSeconds = 1.f / SimTickRate;
+
+// Everything the player can do during one simulation step.
+struct TickInput {
+    bool left = false;
+    bool right = false;
+    bool up = false;
+    bool down = false;
+    bool fire = false;      // Space was pressed since the last step
+};
 
-    sf::Texture texture;
+//---------------------------------- TimerWheel ----------------------------------
+// Called when a timer expires. `owner` and `tag` are whatever was passed to
+// schedule(), so no allocation is needed per timer.
+typedef void (*TimerCallback)(void* owner, int tag);
 
-    sf::Clock bombTimer;
-    float bombCooldown = 5.f; // default for Alpha
+struct TimerHandle {
+    uint32_t index = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+};
 
+// Hierarchical timer wheel keyed on simulation ticks. Level 0 has 256 one-tick
+// slots, level 1 has 64 slots of 256 ticks that cascade into level 0 as the wheel
+// turns, and anything beyond that waits in an overflow list that is re-sorted
+// once per level-1 revolution. Scheduling, cancelling and each expiry are O(1).
+class TimerWheel {
+private:
+    static constexpr uint32_t None = 0xFFFFFFFFu;
+    static const int Level0Bits = 8;
+    static const int Level0Size = 1 << Level0Bits;
+    static const int Level1Size = 64;
+    static const uint64_t Level1Span = static_cast<uint64_t>(Level0Size) * Level1Size;
+
+    struct Node {
+        uint64_t expiry = 0;
+        TimerCallback callback = nullptr;
+        void* owner = nullptr;
+        int tag = 0;
+        uint32_t generation = 0;
+        uint32_t prev = None;
+        uint32_t next = None;
+        uint32_t* list = nullptr;   // head of the slot this node is linked into
+    };
 
-    void setupTexture(const std::string& filepath, float scaleSize, float /*interval*/) {
-        if (!texture.loadFromFile(filepath)) {
-            std::cerr << "[ERROR] Could not load texture: " << filepath << "\n";
-        }
-        sprite.setTexture(texture);
-        sf::Vector2u texSize = texture.getSize();
-        sprite.setScale(scaleSize / texSize.x, scaleSize / texSize.y);
+    std::vector<Node> nodes;
+    uint32_t freeList = None;
+    uint32_t level0[Level0Size];
+    uint32_t level1[Level1Size];
+    uint32_t overflow = None;
+    uint64_t tick = 0;
+
+    void link(uint32_t i, uint32_t* list) {
+        Node& n = nodes[i];
+        n.list = list;
+        n.prev = None;
+        n.next = *list;
+        if (*list != None) nodes[*list].prev = i;
+        *list = i;
     }
 
-public:
-    Invader(sf::Vector2f startPos, sf::Vector2f target)
-        : targetPos(target)
-    {
-        sprite.setPosition(startPos);
+    void unlink(uint32_t i) {
+        Node& n = nodes[i];
+        if (n.prev != None) nodes[n.prev].next = n.next;
+        else *n.list = n.next;
+        if (n.next != None) nodes[n.next].prev = n.prev;
+        n.list = nullptr;
     }
 
-    virtual ~Invader() {}
+    void place(uint32_t i) {
+        uint64_t expiry = nodes[i].expiry;
+        uint64_t delta = expiry - tick;
+        if (delta < Level0Size)
+            link(i, &level0[expiry & (Level0Size - 1)]);
+        else if (delta < Level1Span)
+            link(i, &level1[(expiry >> Level0Bits) & (Level1Size - 1)]);
+        else
+            link(i, &overflow);
+    }
 
-    virtual void update(float dt) {
-        if (!aligned) {
-            sf::Vector2f dir = targetPos - sprite.getPosition();
-            float dist = std::sqrt(dir.x * dir.x + dir.y * dir.y);
-            if (dist < 1.f) {
-                sprite.setPosition(targetPos);
-                aligned = true;
-            }
-            else {
-                dir /= dist;
-                sprite.move(dir * speed * dt);
-            }
+    // Moves every node of a list back through place(); used for cascading.
+    void replaceAll(uint32_t* list) {
+        uint32_t i = *list;
+        *list = None;
+        while (i != None) {
+            uint32_t next = nodes[i].next;
+            place(i);
+            i = next;
         }
     }
 
-    virtual void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
+    void release(uint32_t i) {
+        Node& n = nodes[i];
+        n.generation++;
+        n.callback = nullptr;
+        n.owner = nullptr;
+        n.next = freeList;
+        freeList = i;
     }
 
-    virtual sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+public:
+    TimerWheel() {
+        std::fill(std::begin(level0), std::end(level0), None);
+        std::fill(std::begin(level1), std::end(level1), None);
     }
 
-    virtual sf::Vector2f getBombPosition() const {
-        sf::FloatRect bounds = sprite.getGlobalBounds();
-        return { bounds.left + bounds.width / 2.f, bounds.top + bounds.height };
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Rounds a duration up to whole ticks; never less than one tick.
+    static uint64_t ticksFor(float seconds) {
+        float ticks = std::ceil(seconds * SimTickRate - 1e-4f);
+        return ticks < 1.f ? 1 : static_cast<uint64_t>(ticks);
     }
 
-    bool isAligned() const { return aligned; }
+    uint64_t now() const { return tick; }
 
-    virtual float getBombSpeed() const { return 180.f; } // default speed
+    TimerHandle schedule(uint64_t delayTicks, TimerCallback callback, void* owner, int tag = 0) {
+        uint32_t i;
+        if (freeList != None) {
+            i = freeList;
+            freeList = nodes[i].next;
+        }
+        else {
+            i = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
 
-    void takeDamage() {
-        health--;
+        Node& n = nodes[i];
+        n.expiry = tick + std::max<uint64_t>(delayTicks, 1);
+        n.callback = callback;
+        n.owner = owner;
+        n.tag = tag;
+        place(i);
+
+        TimerHandle handle;
+        handle.index = i;
+        handle.generation = n.generation;
+        return handle;
     }
 
-    bool isDead() const {
-        return health <= 0;
+    TimerHandle scheduleIn(float seconds, TimerCallback callback, void* owner, int tag = 0) {
+        return schedule(ticksFor(seconds), callback, owner, tag);
+    }
+
+    bool isActive(const TimerHandle& handle) const {
+        return handle.index < nodes.size()
+            && nodes[handle.index].generation == handle.generation
+            && nodes[handle.index].list != nullptr;
     }
 
-    virtual bool isBombReady() const {
-        return aligned && bombTimer.getElapsedTime().asSeconds() >= bombCooldown;
+    // Safe on expired or already-cancelled handles.
+    void cancel(TimerHandle& handle) {
+        if (isActive(handle)) {
+            unlink(handle.index);
+            release(handle.index);
+        }
+        handle = TimerHandle();
     }
 
-    virtual void restartBombTimer() {
-        bombTimer.restart();
+    // Advances one tick and fires everything that expires on it. Callbacks may
+    // schedule or cancel other timers.
+    void advance() {
+        tick++;
+        if ((tick & (Level0Size - 1)) == 0) {
+            uint64_t slot = (tick >> Level0Bits) & (Level1Size - 1);
+            if (slot == 0)
+                replaceAll(&overflow);
+            replaceAll(&level1[slot]);
+        }
+
+        uint32_t* list = &level0[tick & (Level0Size - 1)];
+        while (*list != None) {
+            uint32_t i = *list;
+            unlink(i);
+            TimerCallback callback = nodes[i].callback;
+            void* owner = nodes[i].owner;
+            int tag = nodes[i].tag;
+            release(i);
+            callback(owner, tag);
+        }
     }
 
+    size_t activeCount() const {
+        size_t count = 0;
+        for (const auto& n : nodes)
+            if (n.list) count++;
+        return count;
+    }
+};
 
-    const sf::Sprite& getSprite() const { return sprite; }
-    sf::Sprite& getSprite() { return sprite; }
+//---------------------------------- AllocTracker ----------------------------------
+// Opt-in heap instrumentation: build with -DTRACK_ALLOCATIONS and the global
+// operator new/delete below count every allocation against the phase the
+// allocating thread is in. Each frame that allocates is logged with its
+// per-phase counts and bytes; report() gives session totals and a histogram of
+// allocations per frame. Without the define the phase scopes compile to nothing.
+enum AllocPhase {
+    PhaseOther,
+    PhaseInput,
+    PhasePlayer,
+    PhaseBullets,
+    PhaseMonster,
+    PhaseInvaders,
+    PhaseBombs,
+    PhaseAddOns,
+    PhaseCollisions,
+    PhaseExplosions,
+    PhaseHud,
+    PhaseRender,
+    PhaseCount
 };
 
-//-----------------------alpha invader-----------------------------
-class AlphaInvader : public Invader {
+inline const char* allocPhaseName(AllocPhase phase) {
+    static const char* const names[PhaseCount] = {
+        "other", "input", "player", "bullets", "monster", "invaders",
+        "bombs", "add-ons", "collisions", "explosions", "hud", "render"
+    };
+    return names[phase];
+}
 
+#ifdef TRACK_ALLOCATIONS
+class AllocTracker {
 public:
-    AlphaInvader(sf::Vector2f startPos, sf::Vector2f targetPos)
-        : Invader(startPos, targetPos)
-    {
-        setupTexture("assets/alpha_invader.png", 50.f, 5.f); // interval now unused
-        bombCooldown = 5.f;
+    static const int HistogramBuckets = 16;     // 0, 1, 2-3, 4-7, ... allocations
+
+private:
+    struct Counter {
+        std::atomic<unsigned long long> count{ 0 };
+        std::atomic<unsigned long long> bytes{ 0 };
+    };
+
+    struct PhaseTotals {
+        unsigned long long count = 0;
+        unsigned long long bytes = 0;
+        unsigned long long maxPerFrame = 0;
+        unsigned long long frames = 0;      // frames in which the phase allocated
+    };
 
+    // Only touched with plain counters and fixed arrays: anything that
+    // allocated in here would recurse into operator new.
+    Counter frame[PhaseCount];
+    std::atomic<unsigned long long> frees{ 0 };
+    PhaseTotals totals[PhaseCount];
+    unsigned long long histogram[HistogramBuckets] = {};
+    unsigned long long frames = 0;
+    unsigned long long allocatingFrames = 0;
+
+    static AllocPhase& currentPhase() {
+        static thread_local AllocPhase phase = PhaseOther;
+        return phase;
     }
-};
-//-------------------betaInvader-----------------------------------
-class BetaInvader : public Invader {
-public:
-    BetaInvader(sf::Vector2f startPos, sf::Vector2f targetPos)
-        : Invader(startPos, targetPos)
-    {
-        setupTexture("assets/beta_invader.png", 50.f, 3.f);
-        health = 2;
-        bombCooldown = 3.f;
 
+    // Set while the tracker itself prints, so its stream output isn't counted.
+    static bool& muted() {
+        static thread_local bool flag = false;
+        return flag;
     }
-};
 
-//--------------------gammainavder---------------------------------------
-class GammaInvader : public Invader {
-private:
-    bool isDiving = false;
-    sf::Clock diveClock;
-    float diveInterval = 5.f;
-    float diveSpeed = 100.f;
-    float returnSpeed = 80.f;
-    float diveDelay = static_cast<float>(rand() % 3 + 1); // 13s
-    sf::Vector2f originalTarget;
+    static int bucketOf(unsigned long long n) {
+        int b = 0;
+        while (n && b < HistogramBuckets - 1) {
+            n >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    static void printBucket(std::ostream& out, int b) {
+        if (b == 0) out << "0";
+        else if (b == 1) out << "1";
+        else if (b == HistogramBuckets - 1) out << (1ull << (b - 1)) << "+";
+        else out << (1ull << (b - 1)) << "-" << ((1ull << b) - 1);
+    }
 
 public:
-    GammaInvader(sf::Vector2f startPos, sf::Vector2f targetPos)
-        : Invader(startPos, targetPos), originalTarget(targetPos)
-    {
-        setupTexture("assets/gamma_invader.png", 50.f, 2.f);
-        health = 2;
-        bombCooldown = 2.f;
+    static AllocTracker& instance() {
+        static AllocTracker tracker;
+        return tracker;
+    }
 
+    static AllocPhase enter(AllocPhase phase) {
+        AllocPhase previous = currentPhase();
+        currentPhase() = phase;
+        return previous;
     }
 
-    void update(float dt) override {
-        if (!aligned) {
-            Invader::update(dt);
+    void recordAlloc(size_t bytes) {
+        if (muted())
             return;
-        }
-
-        float elapsed = diveClock.getElapsedTime().asSeconds();
+        Counter& c = frame[currentPhase()];
+        c.count.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
 
-        if (!isDiving && elapsed > (diveDelay + diveInterval)) {
-            isDiving = true;
-            diveClock.restart();
-        }
+    void recordFree() {
+        if (!muted())
+            frees.fetch_add(1, std::memory_order_relaxed);
+    }
 
-        if (isDiving) {
-            if (sprite.getPosition().y < originalTarget.y + 150.f) {
-                sprite.move(0, diveSpeed * dt);
-            }
-            else {
-                isDiving = false;
-                diveClock.restart();
-            }
+    // Folds this frame into the session totals and logs it if it allocated.
+    void endFrame(std::ostream& log) {
+        unsigned long long counts[PhaseCount], bytes[PhaseCount], sum = 0;
+        for (int i = 0; i < PhaseCount; ++i) {
+            counts[i] = frame[i].count.exchange(0, std::memory_order_relaxed);
+            bytes[i] = frame[i].bytes.exchange(0, std::memory_order_relaxed);
+            sum += counts[i];
         }
-        else if (sprite.getPosition().y > originalTarget.y) {
-            sprite.move(0, -returnSpeed * dt);
+        frames++;
+        histogram[bucketOf(sum)]++;
+        if (sum == 0)
+            return;
+        allocatingFrames++;
+
+        muted() = true;
+        log << "[Alloc] frame " << frames << ":";
+        for (int i = 0; i < PhaseCount; ++i) {
+            if (counts[i] == 0)
+                continue;
+            PhaseTotals& t = totals[i];
+            t.count += counts[i];
+            t.bytes += bytes[i];
+            t.maxPerFrame = std::max(t.maxPerFrame, counts[i]);
+            t.frames++;
+            log << " " << allocPhaseName(static_cast<AllocPhase>(i)) << " " << counts[i]
+                << " (" << bytes[i] << " B)";
         }
+        log << "\n";
+        muted() = false;
     }
 
-    float getBombSpeed() const override {
-        return 220.f; // Gamma drops faster bombs
+    void report(std::ostream& out) {
+        muted() = true;
+        out << "[Alloc] " << frames << " frames, " << allocatingFrames << " allocated, "
+            << frees.load() << " frees\n";
+        out << "  phase        allocs       bytes   frames  max/frame\n";
+        for (int i = 0; i < PhaseCount; ++i) {
+            const PhaseTotals& t = totals[i];
+            if (t.count == 0)
+                continue;
+            out << "  " << std::left << std::setw(11) << allocPhaseName(static_cast<AllocPhase>(i))
+                << std::right << std::setw(8) << t.count << std::setw(12) << t.bytes
+                << std::setw(9) << t.frames << std::setw(11) << t.maxPerFrame << "\n";
+        }
+        out << "  allocations per frame:\n";
+        for (int b = 0; b < HistogramBuckets; ++b) {
+            if (histogram[b] == 0)
+                continue;
+            out << "    ";
+            printBucket(out, b);
+            out << "\t" << histogram[b] << "\n";
+        }
+        muted() = false;
     }
 };
 
-//----------------------------- Monster Invader -----------------------------
-class Monster : public Invader {
+// Everything allocated while this scope is alive is billed to `phase`;
+// enter() moves the rest of the scope on to the next phase.
+class AllocPhaseScope {
 private:
-    sf::Clock beamClock;
-    bool isFiring = false;
-    float beamDuration = 1.0f;
-    float beamCooldown = 2.0f;
-    bool alreadyDodged = false;
-
-    int maxHealth;
-    bool isMoving = true;
-
-    sf::Texture lightningTexture;
-    sf::Sprite lightningSprite;
+    AllocPhase previous;
 
-    sf::RectangleShape healthBarBack;
-    sf::RectangleShape healthBarFront;
+public:
+    explicit AllocPhaseScope(AllocPhase phase) : previous(AllocTracker::enter(phase)) {}
+    ~AllocPhaseScope() { AllocTracker::enter(previous); }
+    AllocPhaseScope(const AllocPhaseScope&) = delete;
+    AllocPhaseScope& operator=(const AllocPhaseScope&) = delete;
 
-    float direction = 1.f;
-    float moveSpeed = 100.f;
-    float minX = 100.f;
-    float maxX = 600.f;
+    void enter(AllocPhase phase) { AllocTracker::enter(phase); }
+};
 
+inline void allocEndFrame(std::ostream& log) { AllocTracker::instance().endFrame(log); }
+inline void allocReport(std::ostream& out) { AllocTracker::instance().report(out); }
+
+void* operator new(std::size_t size) {
+    AllocTracker::instance().recordAlloc(size);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr)
+        return;
+    AllocTracker::instance().recordFree();
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept { ::operator delete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { ::operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { ::operator delete(ptr); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    AllocTracker::instance().recordAlloc(size);
+    const size_t a = static_cast<size_t>(align);
+#ifdef _MSC_VER
+    void* ptr = _aligned_malloc(size ? size : 1, a);
+#else
+    void* ptr = std::aligned_alloc(a, (size + a - 1) / a * a);
+#endif
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    if (!ptr)
+        return;
+    AllocTracker::instance().recordFree();
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete[](void* ptr, std::align_val_t align) noexcept { ::operator delete(ptr, align); }
+void operator delete(void* ptr, std::size_t, std::align_val_t align) noexcept { ::operator delete(ptr, align); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t align) noexcept { ::operator delete(ptr, align); }
+#else
+class AllocPhaseScope {
 public:
-    Monster(sf::Vector2f pos) : Invader(pos, pos)
-    {
-        setupTexture("assets/monster.png", 180.f, 0);  // Monster texture
-        sprite.setPosition(pos);
+    explicit AllocPhaseScope(AllocPhase) {}
+    void enter(AllocPhase) {}
+};
 
-        health = 30;
-        maxHealth = 30;
+inline void allocEndFrame(std::ostream&) {}
+inline void allocReport(std::ostream&) {}
+#endif
 
-        // Health bar setup
-        healthBarBack.setSize(sf::Vector2f(sprite.getGlobalBounds().width, 8.f));
-        healthBarBack.setFillColor(sf::Color::Red);
+//---------------------------------- ObjectPool ----------------------------------
+struct PoolHandle {
+    uint32_t index = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+};
 
-        healthBarFront.setSize(sf::Vector2f(sprite.getGlobalBounds().width, 8.f));
-        healthBarFront.setFillColor(sf::Color::Green);
+// Fixed-capacity storage for short-lived entities. Every slot is allocated up
+// front; acquire() constructs into a free slot and release() destroys the object
+// and returns the slot to the free list, both O(1). Objects never move, so
+// pointers stay valid until released, and the live slots are also kept in a
+// dense list so iteration only visits live objects. SlotSize may be larger than
+// sizeof(T) to hold classes derived from T; T then needs a virtual destructor.
+template <class T, size_t SlotSize = sizeof(T), size_t SlotAlign = alignof(T)>
+class ObjectPool {
+private:
+    static constexpr uint32_t None = 0xFFFFFFFFu;
+
+    struct Slot {
+        alignas(SlotAlign) unsigned char storage[SlotSize];
+        T* object = nullptr;        // null while the slot is free
+        uint32_t generation = 0;
+        uint32_t liveIndex = None;  // position in `live`
+        uint32_t nextFree = None;
+    };
 
-        // Load lightning beam texture
-        if (!lightningTexture.loadFromFile("assets/lightning.png")) {
-            std::cerr << "[ERROR] Failed to load lightning.png\n";
-        }
-        lightningSprite.setTexture(lightningTexture);
-        lightningSprite.setScale(0.1f, 0.7f);  // Adjust this based on image size
+    std::vector<Slot> slots;
+    std::vector<uint32_t> live;
+    uint32_t freeList = None;
+    size_t highWater = 0;
+    size_t rejected = 0;    // acquires refused because every slot was taken
+
+    uint32_t slotOf(const T* object) const {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(object);
+        const unsigned char* base = reinterpret_cast<const unsigned char*>(slots.data());
+        return static_cast<uint32_t>((p - base) / sizeof(Slot));
     }
 
-    void update(float dt) override {
-        // Update beam position
-        float beamX = sprite.getPosition().x + sprite.getGlobalBounds().width / 2.f - lightningSprite.getGlobalBounds().width / 2.f;
-        float beamY = sprite.getPosition().y + sprite.getGlobalBounds().height;
-        lightningSprite.setPosition(beamX, beamY);
+    void releaseSlot(uint32_t i) {
+        Slot& slot = slots[i];
+        slot.object->~T();
+        slot.object = nullptr;
+        slot.generation++;
 
-        // Update health bar
-        sf::Vector2f pos = sprite.getPosition();
-        float width = sprite.getGlobalBounds().width;
-        healthBarBack.setPosition(pos.x, pos.y - 10.f);
-        healthBarFront.setPosition(pos.x, pos.y - 10.f);
+        uint32_t moved = live.back();
+        live[slot.liveIndex] = moved;
+        slots[moved].liveIndex = slot.liveIndex;
+        live.pop_back();
+        slot.liveIndex = None;
 
-        float healthPercent = static_cast<float>(health) / maxHealth;
-        healthBarFront.setSize(sf::Vector2f(width * healthPercent, 8.f));
+        slot.nextFree = freeList;
+        freeList = i;
+    }
 
-        // Beam firing logic
-        if (isMoving) {
-            sprite.move(direction * moveSpeed * dt, 0.f);
-            if (sprite.getPosition().x < minX || sprite.getPosition().x > maxX) {
-                direction *= -1.f;
-            }
-            if (beamClock.getElapsedTime().asSeconds() >= beamCooldown) {
-                isMoving = false;
-                isFiring = true;
-                beamClock.restart();
-            }
-        }
-        else {
-            if (beamClock.getElapsedTime().asSeconds() >= beamDuration) {
-                isFiring = false;
-                isMoving = true;
-                beamClock.restart();
-            }
+    template <class Pool, class Ref>
+    class Iter {
+    private:
+        Pool* pool;
+        size_t i;
+
+    public:
+        Iter(Pool* p, size_t index) : pool(p), i(index) {}
+        Ref operator*() const { return (*pool)[i]; }
+        Iter& operator++() { ++i; return *this; }
+        bool operator!=(const Iter& other) const { return i != other.i; }
+    };
+
+public:
+    explicit ObjectPool(size_t capacity) : slots(capacity) {
+        live.reserve(capacity);
+        for (size_t i = capacity; i-- > 0;) {
+            slots[i].nextFree = freeList;
+            freeList = static_cast<uint32_t>(i);
         }
     }
 
-    void draw(sf::RenderWindow& window) override {
-        window.draw(sprite);
-        if (isFiring)
-            window.draw(lightningSprite);  // draw the image-based lightning beam
+    ~ObjectPool() { clear(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Returns null when the pool is full.
+    template <class U = T, class... Args>
+    U* acquire(Args&&... args) {
+        static_assert(std::is_same<T, U>::value || std::is_base_of<T, U>::value, "pooled type must derive from T");
+        static_assert(sizeof(U) <= SlotSize && alignof(U) <= SlotAlign, "pooled type does not fit a slot");
+        static_assert(std::is_same<T, U>::value || std::has_virtual_destructor<T>::value,
+            "derived types are destroyed through T");
 
-        window.draw(healthBarBack);
-        window.draw(healthBarFront);
+        if (freeList == None) {
+            rejected++;
+            return nullptr;
+        }
+        uint32_t i = freeList;
+        Slot& slot = slots[i];
+        U* object = new (slot.storage) U(std::forward<Args>(args)...);
+        freeList = slot.nextFree;
+        slot.object = object;
+        slot.liveIndex = static_cast<uint32_t>(live.size());
+        live.push_back(i);
+        highWater = std::max(highWater, live.size());
+        return object;
     }
 
-    sf::Vector2f getPosition() const {
-        return sprite.getPosition();
+    PoolHandle handleOf(const T* object) const {
+        PoolHandle handle;
+        handle.index = slotOf(object);
+        handle.generation = slots[handle.index].generation;
+        return handle;
     }
 
-    bool isBeamActive() const {
-        return isFiring;
+    // Null once the object the handle was taken from has been released.
+    T* get(const PoolHandle& handle) const {
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+            return nullptr;
+        return slots[handle.index].object;
     }
 
-    sf::FloatRect getBeamBounds() const {
-        return lightningSprite.getGlobalBounds();  // updated to match sprite
+    void release(T* object) { releaseSlot(slotOf(object)); }
+
+    void release(const PoolHandle& handle) {
+        if (T* object = get(handle)) release(object);
     }
 
-    bool hasDodged() const {
-        return alreadyDodged;
+    // Releasing moves the last live object into the released one's place, so
+    // a loop over indices that releases element i must not advance past it.
+    template <class Pred>
+    void releaseIf(Pred pred) {
+        for (size_t i = 0; i < live.size();) {
+            if (pred(*slots[live[i]].object)) releaseSlot(live[i]);
+            else ++i;
+        }
     }
 
-    void markDodged() {
-        alreadyDodged = true;
+    void clear() {
+        while (!live.empty())
+            releaseSlot(live.back());
     }
+
+    T& operator[](size_t i) { return *slots[live[i]].object; }
+    const T& operator[](size_t i) const { return *slots[live[i]].object; }
+
+    Iter<ObjectPool, T&> begin() { return Iter<ObjectPool, T&>(this, 0); }
+    Iter<ObjectPool, T&> end() { return Iter<ObjectPool, T&>(this, live.size()); }
+    Iter<const ObjectPool, const T&> begin() const { return Iter<const ObjectPool, const T&>(this, 0); }
+    Iter<const ObjectPool, const T&> end() const { return Iter<const ObjectPool, const T&>(this, live.size()); }
+
+    size_t size() const { return live.size(); }
+    bool empty() const { return live.empty(); }
+    size_t getCapacity() const { return slots.size(); }
+    size_t getHighWater() const { return highWater; }
+    size_t getRejected() const { return rejected; }
 };
 
-//-----------------------------Screen Base-Class----------------------------
-class Screen {
+//---------------------------------- FrameArena ----------------------------------
+// Bump allocator for temporaries that die with the frame: scratch strings and
+// vectors take memory from it through std::pmr, and endFrame() rewinds it in
+// one step. Nothing allocated here may be kept past endFrame().
+// Requests beyond the buffer go to the global heap and are counted, so a
+// non-zero overflow count means Capacity is too small.
+class FrameArena : public std::pmr::memory_resource {
 public:
-    virtual void handleEvents(sf::RenderWindow& window, GameState& state) = 0;
-    virtual void update(GameState& state) = 0;
-    virtual void render(sf::RenderWindow& window) = 0;
-    virtual ~Screen() {}
-};
+    static const size_t Capacity = 64 * 1024;
 
-//--------------------MenuScreen----------------------------------------
-class MenuScreen : public Screen {
 private:
-    sf::Texture backgroundTexture;
-    sf::Sprite backgroundSprite;
-
-    sf::Texture logoTexture;
-    sf::Sprite logoSprite;
+    std::unique_ptr<unsigned char[]> buffer{ new unsigned char[Capacity] };
+    size_t used = 0;
+    size_t framePeak = 0;       // bytes used by the last finished frame
+    size_t peak = 0;            // worst frame so far
+    size_t overflows = 0;
+    size_t overflowBytes = 0;
+    unsigned long long frames = 0;
+
+    FrameArena() {}
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if (start + bytes <= Capacity) {
+            used = start + bytes;
+            return buffer.get() + start;
+        }
+        overflows++;
+        overflowBytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
 
-    sf::Font font;
-    sf::Text title, playText, instructionsText, highScoreText;
+    // Arena memory is only given back by endFrame(); overflow blocks go
+    // straight back to the heap.
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+        unsigned char* c = static_cast<unsigned char*>(ptr);
+        if (c < buffer.get() || c >= buffer.get() + Capacity)
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+    }
 
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
 
 public:
-    MenuScreen() {
-        // Load Background
-        backgroundTexture.loadFromFile("assets/menu_bg.png");
-        backgroundSprite.setTexture(backgroundTexture);
-
-        // Load Logo
-        logoTexture.loadFromFile("assets/space_logo.png");
-        logoSprite.setTexture(logoTexture);
-        logoSprite.setScale(0.55f, 0.55f);
-        logoSprite.setPosition(190.f, 50.f);
+    static FrameArena& instance() {
+        static FrameArena arena;
+        return arena;
+    }
 
-        font.loadFromFile("assets/impact.ttf");
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
 
-        playText.setFont(font);
-        playText.setString("Play");
-        playText.setCharacterSize(30);
-        playText.setFillColor(sf::Color::Green);
-        playText.setPosition(290, 300);
-        playText.setOutlineColor(sf::Color::Black);
-        playText.setOutlineThickness(2);
+    void endFrame() {
+        framePeak = used;
+        peak = std::max(peak, used);
+        used = 0;
+        frames++;
+    }
 
+    size_t getUsed() const { return used; }
+    size_t getFramePeak() const { return framePeak; }
+    size_t getPeak() const { return peak; }
+    size_t getOverflows() const { return overflows; }
 
-        instructionsText.setFont(font);
-        instructionsText.setString("Instructions");
-        instructionsText.setCharacterSize(30);
-        instructionsText.setFillColor(sf::Color::Yellow);
-        instructionsText.setPosition(290, 350);
-        instructionsText.setOutlineColor(sf::Color::Black);
-        instructionsText.setOutlineThickness(2);
+    void report(std::ostream& out) const {
+        out << "[FrameArena] " << frames << " frames, peak " << peak << "/" << Capacity
+            << " bytes, " << overflows << " overflows (" << overflowBytes << " bytes)\n";
+    }
+};
 
-        highScoreText.setFont(font);
-        highScoreText.setString("High Scores");
-        highScoreText.setCharacterSize(30);
-        highScoreText.setFillColor(sf::Color::Cyan);
-        highScoreText.setPosition(290, 400);
-        highScoreText.setOutlineColor(sf::Color::Black);
-        highScoreText.setOutlineThickness(2);
+typedef std::pmr::string ScratchString;
+template<class T> using ScratchVector = std::pmr::vector<T>;
+
+// A string backed by this frame's arena.
+inline ScratchString scratchString(const char* text = "") {
+    return ScratchString(text, &FrameArena::instance());
+}
+
+inline ScratchString& appendNumber(ScratchString& s, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    s.append(digits, result.ptr);
+    return s;
+}
+
+//---------------------------------- Varint ----------------------------------
+// LEB128 varints, used by the replay format and RNG snapshots.
+inline void writeVarint(std::ostream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+inline bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == EOF)
+            return false;
+        value |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+//---------------------------------- Random ----------------------------------
+// PCG32 (O'Neill, pcg-random.org): 64-bit state, 32-bit output, and a stream
+// selector, so differently numbered streams from the same seed never overlap.
+// Results are defined by this code alone rather than by the standard library's
+// distributions, which keeps replays portable between compilers.
+class Pcg32 {
+private:
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc = 0xda3e39cb94b95bdbULL;
 
+public:
+    typedef uint32_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    void seed(uint64_t initState, uint64_t stream) {
+        state = 0;
+        inc = (stream << 1u) | 1u;
+        next();
+        state += initState;
+        next();
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
 
-            // Mouse click handling
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+    result_type operator()() { return next(); }
 
-                    if (playText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::NameInput;
-                    }
-                    else if (instructionsText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::Instructions;
-                    }
-                    else if (highScoreText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::HighScore;
-                    }
-                }
-            }
+    // Unbiased integer in [0, bound).
+    uint32_t below(uint32_t bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        for (;;) {
+            uint32_t r = next();
+            if (r >= threshold)
+                return r % bound;
         }
     }
 
-    void update(GameState& state) override {
+    // Integer in [lo, hi].
+    int range(int lo, int hi) {
+        return lo + static_cast<int>(below(static_cast<uint32_t>(hi - lo + 1)));
+    }
 
+    // Float in [0, 1).
+    float unit() {
+        return (next() >> 8) * (1.f / 16777216.f);
     }
 
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundSprite);
-        window.draw(logoSprite);
-        window.draw(playText);
-        window.draw(instructionsText);
-        window.draw(highScoreText);
-        window.display();
+    void save(std::ostream& out) const {
+        writeVarint(out, state);
+        writeVarint(out, inc);
+    }
 
+    bool load(std::istream& in) {
+        uint64_t s = 0, i = 0;
+        if (!readVarint(in, s) || !readVarint(in, i) || !(i & 1u))
+            return false;
+        state = s;
+        inc = i;
+        return true;
     }
 };
-//--------------------InstructionScreen----------------------------------------
-class InstructionScreen : public Screen {
-private:
-    sf::Font font;
-    sf::Text  header, controls, tips, returnText;
-    sf::Texture backgroundTexture;
-    sf::Sprite backgroundSprite;
 
-    sf::Clock blinkClock;   // For blinking/fading animation
+// One generator per subsystem. Drawing more often in one (say, a new cosmetic
+// effect) leaves the sequence every other subsystem sees unchanged.
+enum RngStream {
+    RngSpawns,      // add-on drops, monster timing
+    RngAI,          // invader behaviour
+    RngBombs,       // which invaders drop bombs
+    RngCosmetics,   // visual-only effects; never affects gameplay
+    RngStreamCount
+};
+
+class RandomStreams {
+private:
+    Pcg32 streams[RngStreamCount];
 
 public:
-    InstructionScreen() {
-        font.loadFromFile("assets/impact.ttf");
-        backgroundTexture.loadFromFile("assets/b2.png");
-        backgroundSprite.setTexture(backgroundTexture);
-        backgroundSprite.setScale(
-            800.f / backgroundTexture.getSize().x,
-            600.f / backgroundTexture.getSize().y
-        );
-        //header section
-        header.setFont(font);
-        header.setString("MISSION BRIEFING");
-        header.setCharacterSize(42);
-        header.setFillColor(sf::Color(0, 255, 255));
-        header.setOutlineColor(sf::Color(0, 150, 255));
-        header.setOutlineThickness(3);
-        header.setPosition(220.f, 40.f);
+    void seed(uint64_t seed) {
+        for (int s = 0; s < RngStreamCount; ++s)
+            streams[s].seed(seed, static_cast<uint64_t>(s));
+    }
 
-        //controls section
-        controls.setFont(font);
-        controls.setCharacterSize(22);
-        controls.setFillColor(sf::Color::White);
-        controls.setOutlineColor(sf::Color(0, 100, 200));
-        controls.setOutlineThickness(2);
-        controls.setString(
-            "Controls:\n"
-            "  ? Move Up:         W\n"
-            "  ? Move Down:    S\n"
-            "  ? Move Left:       A\n"
-            "  ? Move Right:     D\n"
-            "  ? Shoot:           Spacebar\n"
-            "  ? Pause:           Escape"
-        );
-        controls.setPosition(100.f, 100.f);
-
-        //tips section
-        tips.setFont(font);
-        tips.setCharacterSize(22);
-        tips.setFillColor(sf::Color::White);
-        tips.setOutlineColor(sf::Color(0, 100, 200));
-        tips.setOutlineThickness(2);
+    Pcg32& operator[](RngStream s) { return streams[s]; }
 
-        tips.setString(
-            "Tips:\n"
-            "   Avoid Invader fire.\n"
-            "   Collect power-ups.\n"
-            "   Earn high scores to win badges!"
-        );
-        tips.setPosition(100.f, 300.f);
+    void save(std::ostream& out) const {
+        for (const auto& s : streams)
+            s.save(out);
+    }
 
-        //Press M to Return Prompt
-        returnText.setFont(font);
-        returnText.setCharacterSize(22);
-        returnText.setString("? Back");
-        returnText.setPosition(16.f, 20.f);
-        returnText.setStyle(sf::Text::Italic);
-        returnText.setFillColor(sf::Color::White);
-        returnText.setOutlineThickness(2);
+    bool load(std::istream& in) {
+        RandomStreams loaded;
+        for (auto& s : loaded.streams)
+            if (!s.load(in))
+                return false;
+        *this = loaded;
+        return true;
     }
+};
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+//---------------------------------- Interpolation ----------------------------------
+// Offset that draws an entity between its previous and current tick positions
+// (alpha 0 = previous, 1 = current). Jumps of 100px or more are wrap-arounds or
+// teleports, so those are not blended.
+inline sf::Vector2f interpolationOffset(sf::Vector2f previous, sf::Vector2f current, float alpha) {
+    sf::Vector2f delta = current - previous;
+    if (std::abs(delta.x) < 100.f && std::abs(delta.y) < 100.f)
+        return -delta * (1.f - alpha);
+    return sf::Vector2f(0.f, 0.f);
+}
+
+//---------------------------------- SpriteBatch ----------------------------------
+// Per-frame counters reported by SpriteBatch.
+struct RenderStats {
+    unsigned drawCalls = 0;
+    unsigned vertices = 0;
+};
 
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+// Collects the quads of one render layer, bucketed by texture, and submits each
+// bucket with a single draw call. Entities append their sprites here instead of
+// drawing them, so a frame costs one call per texture on screen rather than one
+// per sprite. Buckets keep their vertex storage between frames.
+class SpriteBatch {
+private:
+    struct Bucket {
+        const sf::Texture* texture;
+        sf::VertexArray quads;
+    };
 
-                    if (returnText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::Menu;
-                    }
-                }
-            }
+    std::vector<Bucket> buckets;    // a handful per layer, in order of first use
+    RenderStats stats;
 
-        }
+    sf::VertexArray& bucketFor(const sf::Texture* texture) {
+        for (auto& b : buckets)
+            if (b.texture == texture)
+                return b.quads;
+        buckets.push_back({ texture, sf::VertexArray(sf::Quads) });
+        return buckets.back().quads;
     }
 
-    void update(GameState& state) override {
-         
+public:
+    // Appends a sprite as it would be drawn, moved by `offset` (interpolation).
+    void add(const sf::Sprite& sprite, sf::Vector2f offset = sf::Vector2f()) {
+        const sf::IntRect& rect = sprite.getTextureRect();
+        const sf::Transform& transform = sprite.getTransform();
+        float w = static_cast<float>(std::abs(rect.width));
+        float h = static_cast<float>(std::abs(rect.height));
+        float u0 = static_cast<float>(rect.left);
+        float v0 = static_cast<float>(rect.top);
+        float u1 = u0 + rect.width;
+        float v1 = v0 + rect.height;
+        sf::Color color = sprite.getColor();
+
+        sf::VertexArray& quads = bucketFor(sprite.getTexture());
+        quads.append(sf::Vertex(transform.transformPoint(sf::Vector2f(0.f, 0.f)) + offset, color, sf::Vector2f(u0, v0)));
+        quads.append(sf::Vertex(transform.transformPoint(sf::Vector2f(w, 0.f)) + offset, color, sf::Vector2f(u1, v0)));
+        quads.append(sf::Vertex(transform.transformPoint(sf::Vector2f(w, h)) + offset, color, sf::Vector2f(u1, v1)));
+        quads.append(sf::Vertex(transform.transformPoint(sf::Vector2f(0.f, h)) + offset, color, sf::Vector2f(u0, v1)));
+    }
 
+    // Appends an untextured, axis-aligned rectangle shape (health bars).
+    void add(const sf::RectangleShape& shape, sf::Vector2f offset = sf::Vector2f()) {
+        sf::FloatRect r = shape.getGlobalBounds();
+        sf::Color color = shape.getFillColor();
+        sf::VertexArray& quads = bucketFor(nullptr);
+        quads.append(sf::Vertex(sf::Vector2f(r.left, r.top) + offset, color));
+        quads.append(sf::Vertex(sf::Vector2f(r.left + r.width, r.top) + offset, color));
+        quads.append(sf::Vertex(sf::Vector2f(r.left + r.width, r.top + r.height) + offset, color));
+        quads.append(sf::Vertex(sf::Vector2f(r.left, r.top + r.height) + offset, color));
     }
 
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundSprite);
-        window.draw(header);
-        window.draw(controls);
-        window.draw(tips);
-        window.draw(returnText);
-        window.display();
+    // Reserves `count` quads on `texture` for the caller to fill in place.
+    sf::Vertex* allocate(const sf::Texture* texture, size_t count) {
+        sf::VertexArray& quads = bucketFor(texture);
+        size_t first = quads.getVertexCount();
+        quads.resize(first + count * 4);
+        return count > 0 ? &quads[first] : nullptr;
+    }
 
+    // Draws and empties every bucket: one draw call per texture used.
+    void flush(sf::RenderTarget& target) {
+        for (auto& b : buckets) {
+            size_t n = b.quads.getVertexCount();
+            if (n == 0)
+                continue;
+            target.draw(b.quads, b.texture);
+            stats.drawCalls++;
+            stats.vertices += static_cast<unsigned>(n);
+            b.quads.clear();
+        }
     }
+
+    void resetStats() { stats = RenderStats(); }
+    const RenderStats& getStats() const { return stats; }
 };
-//--------------------PauseScreen----------------------------------------
-class PauseScreen : public Screen {
+
+
+//---------------------------------- AssetArchive ----------------------------------
+// Read-only memory mapping of a whole file (POSIX mmap / Win32 file mapping).
+class MappedFile {
 private:
-    sf::Font font;
-    sf::Texture backgroundTexture;
-    sf::Sprite backgroundSprite;
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
 
-    sf::Text pauseTitle, resumeText, quitText;
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            close();
+            return false;
+        }
+        bytes = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close();
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        bytes = view == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(view);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        if (!bytes) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<unsigned char*>(bytes), length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
 
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
 
+// One file holding every image pre-decoded to RGBA plus the raw font files,
+// so startup maps it once instead of opening and decoding dozens of PNG/JPGs.
+//
+//     header  "SSPK" | u32 version | u32 count | u64 tocOffset
+//     blobs   16-byte aligned
+//     toc     per entry: u32 nameLength | name | u32 kind | u32 width | u32 height | u64 offset | u64 size
+//
+// Integers are little-endian. Entries are keyed by the file path the loader
+// would otherwise open.
+class AssetArchive {
 public:
-    PauseScreen() {
+    enum Kind : uint32_t { KindImage = 0, KindBlob = 1 };
+
+    struct Entry {
+        Kind kind;
+        unsigned width;
+        unsigned height;
+        uint64_t offset;
+        uint64_t size;
+    };
 
-        font.loadFromFile("assets/impact.ttf");
-        backgroundTexture.loadFromFile("assets/b5.jpg");
+    static const uint32_t Version = 1;
 
-        backgroundSprite.setTexture(backgroundTexture);
-        backgroundSprite.setScale(800.f / backgroundTexture.getSize().x, 600.f / backgroundTexture.getSize().y);
+private:
+    MappedFile file;
+    std::unordered_map<std::string, Entry> entries;
+
+    template <typename T>
+    bool read(uint64_t& pos, T& value) const {
+        if (pos > file.size() || sizeof(T) > file.size() - pos)
+            return false;
+        std::memcpy(&value, file.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
 
-        pauseTitle.setFont(font);
-        pauseTitle.setString("GAME PAUSED");
-        pauseTitle.setCharacterSize(60);
-        pauseTitle.setFillColor(sf::Color(217, 130, 7));
-        pauseTitle.setOutlineColor(sf::Color::Black);
-        pauseTitle.setOutlineThickness(3);
-        pauseTitle.setPosition(220.f, 150.f);
+public:
+    bool open(const std::string& path) {
+        entries.clear();
+        if (!file.open(path))
+            return false;
+
+        uint64_t pos = 4;
+        uint32_t version = 0, count = 0;
+        uint64_t tocOffset = 0;
+        if (file.size() < 4 || std::memcmp(file.data(), "SSPK", 4) != 0 ||
+            !read(pos, version) || version != Version || !read(pos, count) || !read(pos, tocOffset))
+        {
+            std::cerr << "[ERROR] Not an asset archive: " << path << "\n";
+            file.close();
+            return false;
+        }
 
-        resumeText.setFont(font);
-        resumeText.setString("Resume");
-        resumeText.setCharacterSize(26);
-        resumeText.setFillColor(sf::Color(245, 197, 108));
-        resumeText.setOutlineColor(sf::Color::Black);
-        resumeText.setPosition(250.f, 260.f);
+        pos = tocOffset;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t nameLength = 0, kind = 0, width = 0, height = 0;
+            Entry e;
+            if (!read(pos, nameLength) || pos + nameLength > file.size()) {
+                std::cerr << "[ERROR] Corrupt asset archive: " << path << "\n";
+                entries.clear();
+                file.close();
+                return false;
+            }
+            std::string name(reinterpret_cast<const char*>(file.data() + pos), nameLength);
+            pos += nameLength;
+            // Offsets and sizes come straight from the file; written as
+            // subtractions so a huge value can't wrap past the bounds check,
+            // and an image must hold exactly width*height RGBA pixels
+            if (!read(pos, kind) || !read(pos, width) || !read(pos, height) ||
+                !read(pos, e.offset) || !read(pos, e.size) ||
+                e.size > file.size() || e.offset > file.size() - e.size ||
+                (kind != KindImage && kind != KindBlob) ||
+                (kind == KindImage && e.size != static_cast<uint64_t>(width) * height * 4))
+            {
+                std::cerr << "[ERROR] Corrupt asset archive: " << path << "\n";
+                entries.clear();
+                file.close();
+                return false;
+            }
+            e.kind = static_cast<Kind>(kind);
+            e.width = width;
+            e.height = height;
+            entries.emplace(std::move(name), e);
+        }
+        return true;
+    }
 
-        quitText.setFont(font);
-        quitText.setString("Quit");
-        quitText.setCharacterSize(26);
-        quitText.setFillColor(sf::Color(184, 126, 18));
-        quitText.setOutlineColor(sf::Color::Black);
-        quitText.setPosition(220.f, 310.f);
+    bool isOpen() const { return file.data() != nullptr; }
+    size_t getEntryCount() const { return entries.size(); }
 
+    const Entry* find(const std::string& path) const {
+        auto it = entries.find(path);
+        return it != entries.end() ? &it->second : nullptr;
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+    const unsigned char* data(const Entry& e) const { return file.data() + e.offset; }
 
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
-                    if (resumeText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::Playing;
-                    }
-                    else if (quitText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::Menu;
-                    }
-                }
+    // Decodes `path` into `image`, from the archive when it holds the file.
+    static bool loadImage(const AssetArchive* archive, sf::Image& image, const std::string& path) {
+        const Entry* e = archive ? archive->find(path) : nullptr;
+        if (e && e->kind == KindImage) {
+            image.create(e->width, e->height, archive->data(*e));
+            return true;
+        }
+        return image.loadFromFile(path);
+    }
+
+    // Builds an archive from image files (decoded to RGBA) and raw blobs such as
+    // fonts. Missing inputs are reported and skipped.
+    static bool write(const std::string& path, const std::vector<std::string>& images,
+        const std::vector<std::string>& blobs)
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) {
+            std::cerr << "[ERROR] Could not write asset archive: " << path << "\n";
+            return false;
+        }
+
+        auto put32 = [&out](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof v); };
+        auto put64 = [&out](uint64_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof v); };
+        auto align = [&out]() { while (out.tellp() % 16 != 0) out.put('\0'); };
+
+        struct Written {
+            std::string name;
+            Entry entry;
+        };
+        std::vector<Written> toc;
+
+        out.write("SSPK", 4);
+        put32(Version);
+        put32(0);
+        put64(0);
+
+        for (const auto& name : images) {
+            sf::Image image;
+            if (!image.loadFromFile(name)) {
+                std::cerr << "[ERROR] Could not load image for archive: " << name << "\n";
+                continue;
+            }
+            align();
+            sf::Vector2u size = image.getSize();
+            Entry e{ KindImage, size.x, size.y, static_cast<uint64_t>(out.tellp()),
+                static_cast<uint64_t>(size.x) * size.y * 4 };
+            out.write(reinterpret_cast<const char*>(image.getPixelsPtr()), static_cast<std::streamsize>(e.size));
+            toc.push_back({ name, e });
+        }
+        for (const auto& name : blobs) {
+            ifstream in(name, ios::binary);
+            if (!in) {
+                std::cerr << "[ERROR] Could not read file for archive: " << name << "\n";
+                continue;
             }
+            std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            align();
+            Entry e{ KindBlob, 0, 0, static_cast<uint64_t>(out.tellp()), bytes.size() };
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            toc.push_back({ name, e });
+        }
+
+        uint64_t tocOffset = static_cast<uint64_t>(out.tellp());
+        for (const auto& w : toc) {
+            put32(static_cast<uint32_t>(w.name.size()));
+            out.write(w.name.data(), static_cast<std::streamsize>(w.name.size()));
+            put32(w.entry.kind);
+            put32(w.entry.width);
+            put32(w.entry.height);
+            put64(w.entry.offset);
+            put64(w.entry.size);
         }
+
+        out.seekp(8);
+        put32(static_cast<uint32_t>(toc.size()));
+        put64(tocOffset);
+        return static_cast<bool>(out);
     }
+};
 
-    void update(GameState& state) override {
+//---------------------------------- ParallelDecoder ----------------------------------
+// Decodes image files on a pool of worker threads. Each finished image is handed
+// back on the calling thread, in completion order, because texture uploads have
+// to happen on the thread that owns the GL context.
+class ParallelDecoder {
+public:
+    typedef std::function<void(size_t index, sf::Image& image, bool ok)> DecodedFn;
 
+    static unsigned defaultWorkers() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 2;
     }
 
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundSprite);
+    static void run(const std::vector<std::string>& files, const AssetArchive* archive,
+        const DecodedFn& onDecoded, unsigned workers = defaultWorkers())
+    {
+        if (files.empty())
+            return;
 
-        sf::RectangleShape overlay(sf::Vector2f(800.f, 600.f));
-        overlay.setFillColor(sf::Color(0, 0, 0, 130));
-        window.draw(overlay);
+        std::vector<sf::Image> images(files.size());
+        std::vector<unsigned char> ok(files.size(), 0);
+        std::deque<size_t> finished;
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::atomic<size_t> next(0);
+
+        auto work = [&]() {
+            for (;;) {
+                size_t i = next++;
+                if (i >= files.size())
+                    return;
+                bool decoded = AssetArchive::loadImage(archive, images[i], files[i]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ok[i] = decoded;
+                    finished.push_back(i);
+                }
+                ready.notify_one();
+            }
+        };
 
-        window.draw(pauseTitle);
-        window.draw(resumeText);
-        window.draw(quitText);
-        window.display();
+        std::vector<std::thread> threads;
+        workers = static_cast<unsigned>(std::min<size_t>(std::max(workers, 1u), files.size()));
+        for (unsigned w = 0; w < workers; ++w)
+            threads.emplace_back(work);
+
+        for (size_t done = 0; done < files.size(); ++done) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&finished] { return !finished.empty(); });
+                i = finished.front();
+                finished.pop_front();
+            }
+            onDecoded(i, images[i], ok[i] != 0);
+            images[i] = sf::Image();    // release the pixels as soon as they are used
+        }
+
+        for (auto& t : threads)
+            t.join();
     }
 };
 
-//------------------------GamePlayScreen---------------------------
-class GamePlayScreen : public Screen {
+//---------------------------------- TextureAtlas ----------------------------------
+// Packs many images onto a few large pages with a shelf packer, so sprites that
+// come from different files can still share one texture and one batched draw.
+// Pages are built from the image files at startup, or loaded from a manifest
+// written earlier by save() (the --pack-atlas step).
+class TextureAtlas {
+public:
+    struct Region {
+        int page = -1;
+        sf::IntRect rect;
+    };
+
+    // An image to pack: `key` is the path sprites ask for, `file` is what is
+    // actually decoded (a processed copy, or the same path).
+    struct Source {
+        std::string key;
+        std::string file;
+        bool mipmapped;
+    };
+
 private:
-    sf::RectangleShape player;
-    float speed = 200.0f; // pixels per second
+    // Transparent gap between images, wide enough that the first few mip levels
+    // of a page do not bleed neighbours into each other.
+    static const int Padding = 8;
+
+    unsigned pageSize;
+    std::vector<sf::Image> pageImages;
+    std::vector<std::shared_ptr<sf::Texture>> pages;
+    std::unordered_map<std::string, Region> regions;
+    std::vector<std::string> order;     // paths in packing order, for save()
+    // Per page: holds images drawn at several scales and gets smoothing and mip
+    // levels. Those images never share a page with the ones drawn unfiltered.
+    std::vector<unsigned char> pageMipmapped;
+
+    struct Shelf {
+        int page;
+        int y;
+        int height;
+        int x;
+    };
 
 public:
-    GamePlayScreen() {
-        player.setSize(sf::Vector2f(50, 50));
-        player.setFillColor(sf::Color::Cyan);
-        player.setPosition(375, 500);
+    explicit TextureAtlas(unsigned maxPageSize = 4096)
+        : pageSize(std::min(maxPageSize, sf::Texture::getMaximumSize()))
+    {
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Escape)
-                    state = GameState::Menu;
+    // Decodes the images and packs them tallest first. Images that do not fit on
+    // a page, or fail to load, are left out and keep their own texture.
+    void pack(const std::vector<Source>& sources, const AssetArchive* archive = nullptr) {
+        std::vector<std::string> files;
+        for (const auto& source : sources)
+            files.push_back(source.file);
+
+        // Decoded in parallel, then put back in source order so the layout is
+        // the same on every run.
+        std::vector<sf::Image> decoded(sources.size());
+        std::vector<unsigned char> loaded(sources.size(), 0);
+        ParallelDecoder::run(files, archive, [&](size_t i, sf::Image& image, bool ok) {
+            if (!ok) {
+                std::cerr << "[ERROR] Could not load image for atlas: " << files[i] << "\n";
+                return;
             }
+            decoded[i] = std::move(image);
+            loaded[i] = 1;
+        });
+
+        pageMipmapped.clear();
+        std::vector<std::pair<std::string, sf::Image>> images;
+        std::vector<unsigned char> filtered;
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (!loaded[i])
+                continue;
+            sf::Vector2u size = decoded[i].getSize();
+            if (size.x > pageSize || size.y > pageSize)
+                continue;
+            images.emplace_back(sources[i].key, std::move(decoded[i]));
+            filtered.push_back(sources[i].mipmapped);
         }
-    }
+        // Unfiltered images first, then the mipmapped ones; tallest first in each
+        std::vector<size_t> sequence(images.size());
+        for (size_t i = 0; i < sequence.size(); ++i)
+            sequence[i] = i;
+        std::stable_sort(sequence.begin(), sequence.end(), [&](size_t a, size_t b) {
+            if (filtered[a] != filtered[b])
+                return filtered[a] < filtered[b];
+            return images[a].second.getSize().y > images[b].second.getSize().y;
+        });
+
+        const int limit = static_cast<int>(pageSize);
+        std::vector<Shelf> shelves;
+        std::vector<sf::Vector2i> extents;      // used width/height per page
+        for (size_t i : sequence) {
+            const auto& entry = images[i];
+            int w = static_cast<int>(entry.second.getSize().x);
+            int h = static_cast<int>(entry.second.getSize().y);
+
+            // The first mipmapped image starts a fresh page
+            if (!pageMipmapped.empty() && pageMipmapped.back() != filtered[i])
+                shelves.clear();
+
+            Shelf* shelf = nullptr;
+            for (auto& s : shelves) {
+                if (h <= s.height && s.x + w <= limit) {
+                    shelf = &s;
+                    break;
+                }
+            }
+            if (!shelf) {
+                int page = extents.empty() ? -1 : static_cast<int>(extents.size()) - 1;
+                if (page < 0 || extents[page].y + h > limit || pageMipmapped[page] != filtered[i]) {
+                    extents.emplace_back(0, 0);
+                    pageMipmapped.push_back(filtered[i]);
+                    page = static_cast<int>(extents.size()) - 1;
+                }
+                shelves.push_back({ page, extents[page].y, h, 0 });
+                extents[page].y = std::min(limit, extents[page].y + h + Padding);
+                shelf = &shelves.back();
+            }
 
-    void update(GameState& state) override {
-        float dt = 1.0f / 60.0f;
+            Region region;
+            region.page = shelf->page;
+            region.rect = sf::IntRect(shelf->x, shelf->y, w, h);
+            shelf->x = std::min(limit, shelf->x + w + Padding);
+            extents[shelf->page].x = std::max(extents[shelf->page].x, region.rect.left + w);
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-            player.move(-speed * dt, 0);
+            regions[entry.first] = region;
+            order.push_back(entry.first);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-            player.move(speed * dt, 0);
+
+        pageImages.resize(extents.size());
+        for (size_t p = 0; p < extents.size(); ++p)
+            pageImages[p].create(extents[p].x, extents[p].y, sf::Color::Transparent);
+        for (const auto& entry : images) {
+            const Region& region = regions[entry.first];
+            pageImages[region.page].copy(entry.second, region.rect.left, region.rect.top);
         }
     }
 
-    void render(sf::RenderWindow& window) override {
-        window.clear(sf::Color::Black);
-        window.draw(player);
-        window.display();
+    // Turns the packed pages into textures and frees the CPU copies.
+    bool upload() {
+        bool ok = true;
+        pages.clear();
+        for (size_t p = 0; p < pageImages.size(); ++p) {
+            auto texture = std::make_shared<sf::Texture>();
+            if (!texture->loadFromImage(pageImages[p])) {
+                std::cerr << "[ERROR] Could not upload atlas page\n";
+                ok = false;
+            }
+            else if (pageMipmapped[p]) {
+                texture->setSmooth(true);
+                texture->generateMipmap();
+            }
+            pages.push_back(texture);
+        }
+        pageImages.clear();
+        return ok;
     }
-};
-//---------------------------------GameOverScreen----------------------------
-class GameOverScreen : public Screen {
-private:
-    sf::Font font;
-    sf::Text gameOverText, scoreText, backText;
-    sf::RectangleShape backgroundRect;
-    int finalScore = 0;
-
-public:
-    GameOverScreen() {
-        font.loadFromFile("assets/Orbitron-Regular.ttf");
 
-        // Background
-        backgroundRect.setSize(sf::Vector2f(800.f, 600.f));
-        backgroundRect.setFillColor(sf::Color(26, 3, 94));
+    // Writes <prefix>N.png for every page and <prefix>.txt: the page count and
+    // each page's mipmapped flag on one line, then "path page x y width height"
+    // per packed image.
+    bool save(const std::string& prefix) const {
+        for (size_t p = 0; p < pageImages.size(); ++p) {
+            if (!pageImages[p].saveToFile(prefix + std::to_string(p) + ".png")) {
+                std::cerr << "[ERROR] Could not write atlas page " << p << "\n";
+                return false;
+            }
+        }
+        ofstream out(prefix + ".txt");
+        if (!out) {
+            std::cerr << "[ERROR] Could not write atlas manifest: " << prefix << ".txt\n";
+            return false;
+        }
+        out << pageImages.size();
+        for (unsigned char m : pageMipmapped)
+            out << " " << (m ? 1 : 0);
+        out << "\n";
+        for (const auto& path : order) {
+            const Region& r = regions.at(path);
+            out << path << " " << r.page << " " << r.rect.left << " " << r.rect.top
+                << " " << r.rect.width << " " << r.rect.height << "\n";
+        }
+        return true;
+    }
 
-        // GAME OVER Title
-        gameOverText.setFont(font);
-        gameOverText.setString("GAME OVER");
-        gameOverText.setCharacterSize(40);
-        gameOverText.setFillColor(sf::Color(230, 230, 250));
-        gameOverText.setOutlineColor(sf::Color(0, 100, 255));
-        gameOverText.setOutlineThickness(3);
-        gameOverText.setPosition(220, 120);
+    // Loads pages and regions written by save(); false if there is no manifest.
+    bool load(const std::string& prefix, const AssetArchive* archive = nullptr) {
+        ifstream in(prefix + ".txt");
+        size_t pageCount = 0;
+        if (!in || !(in >> pageCount))
+            return false;
+        pageMipmapped.assign(pageCount, 0);
+        for (auto& m : pageMipmapped) {
+            int flag = 0;
+            if (!(in >> flag))
+                return false;
+            m = flag != 0;
+        }
 
-        // Final Score
-        scoreText.setFont(font);
-        scoreText.setCharacterSize(24);
-        scoreText.setFillColor(sf::Color(180, 220, 255));
-        scoreText.setOutlineColor(sf::Color::Black);
-        scoreText.setOutlineThickness(1.5f);
-        scoreText.setPosition(250, 220);
+        std::string path;
+        Region r;
+        while (in >> path >> r.page >> r.rect.left >> r.rect.top >> r.rect.width >> r.rect.height) {
+            if (r.page < 0 || static_cast<size_t>(r.page) >= pageCount)
+                return false;
+            regions[path] = r;
+            order.push_back(path);
+        }
 
-        // Menu Prompt
-        backText.setFont(font);
-        backText.setString("Back to Menu");
-        backText.setCharacterSize(20);
-        backText.setFillColor(sf::Color::White);
-        backText.setOutlineColor(sf::Color(0, 120, 255));
-        backText.setOutlineThickness(2);
-        backText.setStyle(sf::Text::Italic);
-        backText.setPosition(200, 320);
+        pageImages.resize(pageCount);
+        for (size_t p = 0; p < pageCount; ++p) {
+            if (!AssetArchive::loadImage(archive, pageImages[p], prefix + std::to_string(p) + ".png")) {
+                std::cerr << "[ERROR] Could not load atlas page " << p << "\n";
+                regions.clear();
+                order.clear();
+                pageImages.clear();
+                return false;
+            }
+        }
+        return upload();
     }
 
-    void setFinalScore(int score) {
-        finalScore = score;
-        scoreText.setString("Final Score: " + to_string(score));
+    const Region* find(const std::string& path) const {
+        auto it = regions.find(path);
+        return it != regions.end() ? &it->second : nullptr;
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+    std::shared_ptr<sf::Texture> getPage(int page) const { return pages[page]; }
+    size_t getPageCount() const { return std::max(pages.size(), pageImages.size()); }
+    size_t getRegionCount() const { return regions.size(); }
+};
 
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+//---------------------------------- Asset pipeline ----------------------------------
+// Every image drawn during gameplay and the largest size it is drawn at: either
+// a scale factor or, for sprites fitted to a box, the box size in pixels. The
+// atlas packs these, and --process-assets resamples them to that size. Keep the
+// numbers in step with the setScale/setupTexture calls of each entity.
+struct GameplaySprite {
+    const char* path;
+    float scaleX, scaleY;   // used when fitPx is 0
+    float fitPx;            // setupTexture() size
+    bool varyingScale;      // drawn at several scales; gets mip levels
+};
 
-                    if (backText.getGlobalBounds().contains(mousePos)) {
-                        state = GameState::Menu;
-                    }
+inline const std::vector<GameplaySprite>& gameplaySprites() {
+    static const std::vector<GameplaySprite> sprites = {
+        { "assets/sp.png",             0.10f,  0.10f,  0.f,   false },
+        { "assets/bullet.png",         0.05f,  0.05f,  0.f,   false },
+        { "assets/bomb.png",           0.03f,  0.03f,  0.f,   false },
+        { "assets/alpha_invader.png",  0.f,    0.f,    50.f,  false },
+        { "assets/beta_invader.png",   0.f,    0.f,    50.f,  false },
+        { "assets/gamma_invader.png",  0.f,    0.f,    50.f,  false },
+        { "assets/monster.png",        0.f,    0.f,    180.f, false },
+        { "assets/lightning.png",      0.1f,   0.7f,   0.f,   false },
+        { "assets/explosion2.png",     0.5f,   0.5f,   0.f,   true },   // 0.08 invaders, 0.5 monster
+        { "assets/powerUp.png",        0.05f,  0.05f,  0.f,   false },
+        { "assets/extra_life.png",     0.04f,  0.04f,  0.f,   false },
+        { "assets/danger_sign.png",    0.008f, 0.008f, 0.f,   false },
+    };
+    return sprites;
+}
+
+// Every image the game loads at startup: the menu and name entry backgrounds
+// plus the gameplay sprites.
+inline std::vector<std::string> startupImagePaths() {
+    std::vector<std::string> paths = {
+        "assets/menu_bg.png",
+        "assets/space_logo.png",
+        "assets/b4.jpg",
+    };
+    for (const auto& sprite : gameplaySprites())
+        paths.push_back(sprite.path);
+    return paths;
+}
+
+// Images of the screens ScreenManager only builds when they are first shown.
+inline std::vector<std::string> screenImagePaths() {
+    return {
+        "assets/b2.png",
+        "assets/b5.jpg",
+        "assets/gold_badge.png",
+        "assets/silver-badge.png",
+        "assets/bronze_badge.png",
+    };
+}
+
+// Area-averaging downscale. Colour is weighted by alpha so transparent pixels
+// do not darken the edges of a sprite.
+inline sf::Image resampleImage(const sf::Image& source, unsigned width, unsigned height) {
+    sf::Vector2u size = source.getSize();
+    const sf::Uint8* in = source.getPixelsPtr();
+    std::vector<sf::Uint8> out(static_cast<size_t>(width) * height * 4);
+
+    for (unsigned y = 0; y < height; ++y) {
+        unsigned y0 = static_cast<unsigned>(static_cast<uint64_t>(y) * size.y / height);
+        unsigned y1 = std::max(y0 + 1, static_cast<unsigned>(static_cast<uint64_t>(y + 1) * size.y / height));
+        for (unsigned x = 0; x < width; ++x) {
+            unsigned x0 = static_cast<unsigned>(static_cast<uint64_t>(x) * size.x / width);
+            unsigned x1 = std::max(x0 + 1, static_cast<unsigned>(static_cast<uint64_t>(x + 1) * size.x / width));
+
+            uint64_t r = 0, g = 0, b = 0, a = 0;
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const sf::Uint8* p = in + (static_cast<size_t>(sy) * size.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, p += 4) {
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
                 }
             }
 
+            sf::Uint8* o = &out[(static_cast<size_t>(y) * width + x) * 4];
+            uint64_t count = static_cast<uint64_t>(y1 - y0) * (x1 - x0);
+            o[3] = static_cast<sf::Uint8>(a / count);
+            if (a > 0) {
+                o[0] = static_cast<sf::Uint8>(r / a);
+                o[1] = static_cast<sf::Uint8>(g / a);
+                o[2] = static_cast<sf::Uint8>(b / a);
+            }
         }
     }
 
-    void update(GameState& state) override {
-        // Nothing for now
-    }
-
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundRect);
-        window.draw(gameOverText);
-        window.draw(scoreText);
-        window.draw(backText);
-        window.display();
-    }
-};
+    sf::Image result;
+    result.create(width, height, out.data());
+    return result;
+}
 
-//-------------------------NameInputScreen----------------------------------------
-class NameInputScreen : public Screen {
+//---------------------------------- ResourceCache ----------------------------------
+// Process-wide cache of textures and fonts keyed by asset path. Every caller asking
+// for the same file gets the same reference-counted object, so a PNG is decoded at
+// most once no matter how many invaders or add-ons use it.
+class ResourceCache {
 private:
-    sf::Font font;
-    sf::Text promptText, nameText, infoText, subtitle;
-    std::string playerName;
-    sf::Texture backgroundTexture;
-    sf::Sprite backgroundSprite;
-    sf::Clock cursorClock, fadeClock;
-    ;
-    sf::RectangleShape underline;
-    bool showCursor = true;
-    bool showWarning = false;
-    sf::Text warningText;
+    std::unordered_map<std::string, std::shared_ptr<sf::Texture>> textures;
+    std::unordered_map<std::string, std::shared_ptr<sf::Font>> fonts;
+    std::unordered_map<std::string, size_t> fontBytes;
+    std::unordered_map<std::string, sf::Vector2u> imageSizes;
+    std::shared_ptr<TextureAtlas> atlas;
+
+    // Downscaled copies written by --process-assets, keyed by original path.
+    struct ProcessedImage {
+        std::string file;
+        sf::Vector2u sourceSize;
+        sf::Vector2u size;
+        bool mipmapped;
+    };
+    std::unordered_map<std::string, ProcessedImage> processed;
 
+    AssetArchive archive;
+    float loadSeconds = 0.f;    // time spent opening and decoding assets
 
+    size_t hits = 0;
+    size_t misses = 0;
+    bool headless = false;
 
-public:
-    NameInputScreen() {
-        font.loadFromFile("assets/impact.ttf");
-        backgroundTexture.loadFromFile("assets/b4.jpg");
-        backgroundSprite.setScale(
-            800.f / backgroundTexture.getSize().x,
-            600.f / backgroundTexture.getSize().y
-        );
-        backgroundSprite.setTexture(backgroundTexture);
+    ResourceCache() {}
 
+    static size_t fileSize(const std::string& path) {
+        ifstream in(path, ios::binary | ios::ate);
+        return in ? static_cast<size_t>(in.tellg()) : 0;
+    }
 
+    // Width and height straight from a PNG's IHDR chunk, no decoding needed.
+    static bool readPngSize(const std::string& path, sf::Vector2u& size) {
+        ifstream in(path, ios::binary);
+        unsigned char header[24];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+        if (header[1] != 'P' || header[2] != 'N' || header[3] != 'G')
+            return false;
+        size.x = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+        size.y = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+        return true;
+    }
 
-        underline.setSize(sf::Vector2f(250.f, 2.f));
-        underline.setFillColor(sf::Color(255, 200, 90));
-        underline.setPosition(30.f, 180.f);
+public:
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
 
-        promptText.setFont(font);
-        promptText.setString("ENTER YOUR CALLSIGN");
-        promptText.setCharacterSize(28);
-        promptText.setPosition(20.f, 90.f);
-        promptText.setFillColor(sf::Color(207, 154, 8));
-        promptText.setStyle(sf::Text::Bold);
-        promptText.setOutlineColor(sf::Color::Black);
-        promptText.setOutlineThickness(2);
-        ;
-        subtitle.setFont(font);
-        subtitle.setString("Press ENTER to initiate mission");
-        subtitle.setCharacterSize(16);
-        subtitle.setFillColor(sf::Color(200, 200, 200));
-        subtitle.setPosition(200, 350);
+    static ResourceCache& instance() {
+        static ResourceCache cache;
+        return cache;
+    }
 
+    // In headless mode textures are handed out empty and never uploaded, so the
+    // simulation can run without a GL context. Sprite sizes still come from
+    // getImageSize().
+    void setHeadless(bool value) { headless = value; }
+    bool isHeadless() const { return headless; }
+
+    // Reads the manifest written by --process-assets. From then on those images
+    // load from their processed files; sizes are read from the manifest, so
+    // headless runs see exactly the same sprite bounds.
+    bool loadProcessedAssets(const std::string& manifest = "assets/processed.txt") {
+        ifstream in(manifest);
+        if (!in)
+            return false;
+        std::string path;
+        ProcessedImage image;
+        while (in >> path >> image.file >> image.sourceSize.x >> image.sourceSize.y
+            >> image.size.x >> image.size.y >> image.mipmapped)
+        {
+            if (image.size.x > 0 && image.size.y > 0)
+                processed[path] = image;
+        }
+        return true;
+    }
 
-        nameText.setFont(font);
-        nameText.setCharacterSize(24);
-        nameText.setFillColor(sf::Color(255, 235, 140));
-        nameText.setPosition(30.f, 156.f);
-        nameText.setOutlineColor(sf::Color::Black);
-        nameText.setOutlineThickness(1.5f);
+    // Serves images and fonts from the packed archive when it exists (built by
+    // --pack-archive). Files missing from it still load from disk.
+    bool openArchive(const std::string& path = "assets/assets.pak") {
+        return archive.open(path);
+    }
 
-        infoText.setFont(font);
-        infoText.setCharacterSize(23);
-        infoText.setFillColor(sf::Color::Yellow);
-        infoText.setString("Press Enter to start playing");
-        infoText.setPosition(40, 215);
+    const AssetArchive* getArchive() const { return archive.isOpen() ? &archive : nullptr; }
 
-        warningText.setFont(font); // use your existing font
-        warningText.setCharacterSize(20);
-        warningText.setFillColor(sf::Color::Red);
-        warningText.setString("Please enter your callsign!");
-        warningText.setPosition(200.f, 300.f); // adjust as needed
+    // The file actually decoded for `path`.
+    std::string resolvePath(const std::string& path) const {
+        auto it = processed.find(path);
+        return it != processed.end() ? it->second.file : path;
+    }
 
+    // Source pixels per stored pixel; 1 unless the image was downscaled.
+    sf::Vector2f getSourceScale(const std::string& path) const {
+        auto it = processed.find(path);
+        if (it == processed.end())
+            return sf::Vector2f(1.f, 1.f);
+        const ProcessedImage& image = it->second;
+        return sf::Vector2f(static_cast<float>(image.sourceSize.x) / image.size.x,
+            static_cast<float>(image.sourceSize.y) / image.size.y);
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+    // Sets a sprite's scale as if its texture were the original image, so the
+    // same factors work for processed and unprocessed assets.
+    void scaleSprite(sf::Sprite& sprite, const std::string& path, float scaleX, float scaleY) const {
+        sf::Vector2f k = getSourceScale(path);
+        sprite.setScale(scaleX * k.x, scaleY * k.y);
+    }
 
-            if (event.type == sf::Event::TextEntered) {
-                if (event.text.unicode == '\b' && !playerName.empty()) {
-                    playerName.pop_back();
-                    showWarning = false;
-                }
-                else if (event.text.unicode >= 32 && event.text.unicode < 128) {
-                    playerName += static_cast<char>(event.text.unicode);
-                    showWarning = false;
-                }
-            }
-            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
-                if (!playerName.empty()) {
-                    state = GameState::Playing;
-                    showWarning = false;
-                }
-                else {
-                    showWarning = true; // Show the warning message
-                }
-            }
+    std::vector<TextureAtlas::Source> atlasSources() const {
+        std::vector<TextureAtlas::Source> sources;
+        for (const auto& sprite : gameplaySprites()) {
+            auto it = processed.find(sprite.path);
+            bool mip = it != processed.end() && it->second.mipmapped;
+            sources.push_back({ sprite.path, resolvePath(sprite.path), mip });
         }
+        return sources;
     }
 
+    // From now on bindSprite() and getRegion() serve packed images from the
+    // atlas pages. Must be set before any sprite is bound.
+    void setAtlas(std::shared_ptr<TextureAtlas> packed) { atlas = std::move(packed); }
 
-    void update(GameState& state) override {
-        if (cursorClock.getElapsedTime().asSeconds() > 0.5f) {
-            showCursor = !showCursor;
-            cursorClock.restart();
+    // Loads the offline atlas (assets/atlas.txt + pages) when it exists and
+    // otherwise packs the gameplay sprites now.
+    void loadAtlas() {
+        if (headless)
+            return;
+        sf::Clock clock;
+        auto packed = std::make_shared<TextureAtlas>();
+        if (!packed->load("assets/atlas", getArchive())) {
+            packed = std::make_shared<TextureAtlas>();
+            packed->pack(atlasSources(), getArchive());
+            packed->upload();
         }
-        int alpha = static_cast<int>(std::abs(std::sin(fadeClock.getElapsedTime().asSeconds() * 2)) * 255);
-        infoText.setFillColor(sf::Color(255, 220, 150, alpha));
-
-        std::string displayName = playerName + (showCursor ? "|" : " ");
-        nameText.setString(displayName);
+        setAtlas(packed);
+        loadSeconds += clock.getElapsedTime().asSeconds();
     }
 
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundSprite);
-        window.draw(promptText);
-        window.draw(nameText);
-        window.draw(underline);
-        window.draw(infoText);
-        if (showWarning) {
-            window.draw(warningText); 
+    // A failed load is cached as an empty texture so it is reported only once;
+    // callers keep checking getSize().x == 0 for their fallbacks.
+    std::shared_ptr<sf::Texture> getTexture(const std::string& path) {
+        auto it = textures.find(path);
+        if (it != textures.end()) {
+            hits++;
+            return it->second;
         }
-        window.display();
-    }
 
-    const std::string& getPlayerName() const {
-        return playerName;
+        misses++;
+        auto texture = std::make_shared<sf::Texture>();
+        if (!headless) {
+            sf::Clock clock;
+            auto image = processed.find(path);
+            std::string file = resolvePath(path);
+            const AssetArchive::Entry* packed = archive.isOpen() ? archive.find(file) : nullptr;
+            bool loaded = false;
+            if (packed && packed->kind == AssetArchive::KindImage) {
+                // Straight from the mapping into the GPU, no decode
+                loaded = texture->create(packed->width, packed->height);
+                if (loaded) texture->update(archive.data(*packed));
+            }
+            else {
+                loaded = texture->loadFromFile(file);
+            }
+            loadSeconds += clock.getElapsedTime().asSeconds();
+
+            if (!loaded) {
+                std::cerr << "[ERROR] Could not load texture: " << path << "\n";
+            }
+            else if (image != processed.end() && image->second.mipmapped) {
+                texture->setSmooth(true);
+                texture->generateMipmap();
+            }
+        }
+        textures.emplace(path, texture);
+        return texture;
     }
-};
 
-//--------------------------------PlayerScore---------------------
-class PlayerScore {
-private:
-    string name;
-    int score;
-    string badge;
+    std::shared_ptr<sf::Font> getFont(const std::string& path) {
+        auto it = fonts.find(path);
+        if (it != fonts.end()) {
+            hits++;
+            return it->second;
+        }
 
-public:
-    PlayerScore() : name(""), score(0), badge("None") {}
-    PlayerScore(string n, int s, string b = "None")
-        : name(n), score(s), badge(b) {
+        misses++;
+        sf::Clock clock;
+        auto font = std::make_shared<sf::Font>();
+        const AssetArchive::Entry* packed = archive.isOpen() ? archive.find(path) : nullptr;
+        // The mapping stays open for the life of the cache, as loadFromMemory needs
+        bool loaded = packed && packed->kind == AssetArchive::KindBlob
+            ? font->loadFromMemory(archive.data(*packed), static_cast<size_t>(packed->size))
+            : font->loadFromFile(path);
+        loadSeconds += clock.getElapsedTime().asSeconds();
+        if (!loaded) {
+            std::cerr << "[ERROR] Could not load font: " << path << "\n";
+        }
+        fonts.emplace(path, font);
+        fontBytes[path] = fileSize(path);
+        return font;
     }
 
-    string getName() const { return name; }
-    int getScore() const { return score; }
-    string getBadge() const { return badge; }
+    // Decodes every listed image that is not cached yet on worker threads and
+    // uploads each one here as it finishes, calling progress(done, total) after
+    // each upload. Images served by the atlas or the archive need no decode and
+    // are skipped.
+    void preload(const std::vector<std::string>& paths,
+        const std::function<void(size_t done, size_t total)>& progress = nullptr)
+    {
+        if (headless)
+            return;
 
-    void setBadge(const string& b) { badge = b; }
+        std::vector<std::string> keys, files;
+        for (const auto& path : paths) {
+            std::string file = resolvePath(path);
+            if (textures.count(path) || (atlas && atlas->find(path)) ||
+                (archive.isOpen() && archive.find(file)))
+                continue;
+            if (std::find(keys.begin(), keys.end(), path) != keys.end())
+                continue;
+            keys.push_back(path);
+            files.push_back(file);
+        }
 
-    bool operator<(const PlayerScore& other) const {
-        return score > other.score;
+        sf::Clock clock;
+        size_t done = 0;
+        ParallelDecoder::run(files, nullptr, [&](size_t i, sf::Image& image, bool ok) {
+            auto texture = std::make_shared<sf::Texture>();
+            if (!ok || !texture->loadFromImage(image)) {
+                std::cerr << "[ERROR] Could not load texture: " << keys[i] << "\n";
+            }
+            else {
+                auto it = processed.find(keys[i]);
+                if (it != processed.end() && it->second.mipmapped) {
+                    texture->setSmooth(true);
+                    texture->generateMipmap();
+                }
+            }
+            misses++;
+            textures.emplace(keys[i], texture);
+            if (progress)
+                progress(++done, files.size());
+        });
+        loadSeconds += clock.getElapsedTime().asSeconds();
     }
 
-    string toLine() const {
-        return name + " " + to_string(score) + " " + badge;
-    }
-    static PlayerScore fromLine(const string& line) {
-        istringstream iss(line);
-        string n, b;
-        int s = 0;
-        iss >> n >> s >> b;
-        return PlayerScore(n, s, b);
+    // Pixel size of an image file. Uses the loaded texture when there is one and
+    // otherwise reads the file header, so it also works headless.
+    sf::Vector2u getImageSize(const std::string& path) {
+        if (const TextureAtlas::Region* region = atlas ? atlas->find(path) : nullptr)
+            return sf::Vector2u(region->rect.width, region->rect.height);
+
+        auto image = processed.find(path);
+        if (image != processed.end())
+            return image->second.size;
+
+        auto tex = textures.find(path);
+        if (tex != textures.end() && tex->second->getSize().x > 0)
+            return tex->second->getSize();
+
+        if (const AssetArchive::Entry* packed = archive.isOpen() ? archive.find(path) : nullptr)
+            if (packed->kind == AssetArchive::KindImage)
+                return sf::Vector2u(packed->width, packed->height);
+
+        auto it = imageSizes.find(path);
+        if (it != imageSizes.end())
+            return it->second;
+
+        sf::Vector2u size(0, 0);
+        if (!readPngSize(path, size)) {
+            sf::Image image;
+            if (image.loadFromFile(path))
+                size = image.getSize();
+        }
+        imageSizes.emplace(path, size);
+        return size;
     }
-};
-
-//-----------------HighScoreManager------------------------------------------
-class HighScoreManager {
-private:
-    string fileName;
-    vector<PlayerScore> scores;
 
-public:
-    HighScoreManager(string file = "highscores.txt") : fileName(file) {
-        loadFromFile();
+    // The texture holding an image and where in it the image is: an atlas page
+    // and sub-rectangle when packed, otherwise its own texture and the full rect.
+    std::shared_ptr<sf::Texture> getRegion(const std::string& path, sf::IntRect& rect) {
+        if (const TextureAtlas::Region* region = atlas ? atlas->find(path) : nullptr) {
+            hits++;
+            rect = region->rect;
+            return atlas->getPage(region->page);
+        }
+        auto texture = getTexture(path);
+        sf::Vector2u size = getImageSize(path);
+        rect = sf::IntRect(0, 0, static_cast<int>(size.x), static_cast<int>(size.y));
+        return texture;
     }
 
-    void loadFromFile() {
-        scores.clear();
+    // Points a sprite at the image's texture region. The rect comes from the
+    // image size, so bounds are right even when the texture was never uploaded.
+    std::shared_ptr<sf::Texture> bindSprite(sf::Sprite& sprite, const std::string& path) {
+        sf::IntRect rect;
+        auto texture = getRegion(path, rect);
+        sprite.setTexture(*texture);
+        sprite.setTextureRect(rect);
+        return texture;
+    }
 
-        ifstream in(fileName);
-        if (!in.is_open()) {
-            // File doesnt exist yet  create empty one
-            ofstream out(fileName);
-            out.close();
-            return;
+    // Drops every entry nobody outside the cache still references.
+    void trim() {
+        for (auto it = textures.begin(); it != textures.end();) {
+            if (it->second.use_count() == 1) it = textures.erase(it);
+            else ++it;
         }
-
-        string line;
-        while (getline(in, line)) {
-            if (!line.empty()) {
-                scores.push_back(PlayerScore::fromLine(line));
+        for (auto it = fonts.begin(); it != fonts.end();) {
+            if (it->second.use_count() == 1) {
+                fontBytes.erase(it->first);
+                it = fonts.erase(it);
             }
+            else ++it;
         }
-
-        in.close();
     }
 
-
-    void saveToFile() {
-        ofstream out(fileName);
-        for (auto& s : scores) {
-            out << s.toLine() << "\n";
+    // Drops just these textures, again only if nobody else holds them.
+    void release(const std::vector<std::string>& paths) {
+        for (const auto& path : paths) {
+            auto it = textures.find(path);
+            if (it != textures.end() && it->second.use_count() == 1)
+                textures.erase(it);
         }
-        out.close();
     }
 
-    void addNewScore(const string& name, int score) {
-        scores.push_back(PlayerScore(name, score));
-        sort(scores.begin(), scores.end());
-
-        if (scores.size() > 3)
-            scores.resize(3);
-
-        assignBadges();
-        saveToFile();
+    std::vector<std::string> getTexturePaths() const {
+        std::vector<std::string> paths;
+        paths.reserve(textures.size());
+        for (const auto& t : textures)
+            paths.push_back(t.first);
+        return paths;
+    }
 
+    size_t getTextureBytes(const std::vector<std::string>& paths) const {
+        size_t bytes = 0;
+        for (const auto& path : paths) {
+            auto it = textures.find(path);
+            if (it == textures.end()) continue;
+            sf::Vector2u size = it->second->getSize();
+            bytes += static_cast<size_t>(size.x) * size.y * 4;
+        }
+        return bytes;
     }
 
-    void assignBadges() {
-        for (size_t i = 0; i < scores.size(); ++i) {
-            if (i == 0) scores[i].setBadge("Gold");
-            else if (i == 1) scores[i].setBadge("Silver");
-            else if (i == 2) scores[i].setBadge("Bronze");
-            else scores[i].setBadge("None");
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+
+    // RGBA texture memory plus the size of each resident font file.
+    size_t getResidentBytes() const {
+        size_t bytes = 0;
+        for (const auto& t : textures) {
+            sf::Vector2u size = t.second->getSize();
+            bytes += static_cast<size_t>(size.x) * size.y * 4;
         }
+        for (const auto& f : fontBytes)
+            bytes += f.second;
+        for (size_t p = 0; atlas && p < atlas->getPageCount(); ++p) {
+            sf::Vector2u size = atlas->getPage(static_cast<int>(p))->getSize();
+            bytes += static_cast<size_t>(size.x) * size.y * 4;
+        }
+        return bytes;
     }
 
-    const vector<PlayerScore>& getScores() const {
-        return scores;
+    void report(std::ostream& out) const {
+        out << "[ResourceCache] textures: " << textures.size()
+            << ", fonts: " << fonts.size()
+            << ", atlas pages: " << (atlas ? atlas->getPageCount() : 0)
+            << ", archive: " << (archive.isOpen() ? "yes" : "no")
+            << ", load: " << static_cast<int>(loadSeconds * 1000.f) << " ms"
+            << ", hits: " << hits
+            << ", misses: " << misses
+            << ", resident: " << getResidentBytes() / 1024 << " KiB\n";
     }
 };
 
-//---------------------------- HighScoreScreen ----------------------------
-class HighScoreScreen : public Screen {
+//---------------------------------- BoundsCache ----------------------------------
+// A sprite's world-space box, kept between reads. getGlobalBounds() rebuilds the
+// transform and maps four corners on every call; for these sprites (no rotation,
+// origin at the top left) the box is the position plus the scaled size, and it
+// is formed with the same float operations so the result matches bit for bit.
+// Owners call markMoved() when the position changes and markResized() when the
+// scale or texture rect does; the box is recomputed on the next read only.
+class BoundsCache {
 private:
-    sf::Font font;
-    sf::Text title, backText;
-    sf::RectangleShape backgroundRect;
+    mutable sf::FloatRect box;
+    mutable sf::Vector2f size;
+    mutable bool sizeDirty = true;
+    mutable bool boxDirty = true;
 
-    sf::Texture goldBadgeTex, silverBadgeTex, bronzeBadgeTex;
-    std::vector<sf::Sprite> badgeSprites;
+public:
+    void markMoved() { boxDirty = true; }
 
-    vector<sf::Text> scoreTexts;
-    HighScoreManager& manager;
+    void markResized() {
+        sizeDirty = true;
+        boxDirty = true;
+    }
 
-public:
-    HighScoreScreen(HighScoreManager& mgr) : manager(mgr) {
-        font.loadFromFile("assets/Orbitron-Regular.ttf");
+    const sf::FloatRect& get(const sf::Sprite& sprite) const {
+        if (sizeDirty) {
+            sf::FloatRect local = sprite.getLocalBounds();
+            sf::Vector2f scale = sprite.getScale();
+            size = sf::Vector2f(scale.x * local.width, scale.y * local.height);
+            sizeDirty = false;
+        }
+        if (boxDirty) {
+            sf::Vector2f pos = sprite.getPosition();
+            box = sf::FloatRect(pos.x, pos.y, (size.x + pos.x) - pos.x, (size.y + pos.y) - pos.y);
+            boxDirty = false;
+        }
+        return box;
+    }
+};
 
-        backgroundRect.setSize(sf::Vector2f(800.f, 600.f));  // Full window
-        backgroundRect.setFillColor(sf::Color(26, 3, 94));  // Custom RGB color
+//---------------------------------- Invader ----------------------------------
+class BombScheduler;
+
+enum InvaderKind {
+    InvaderAlpha,
+    InvaderBeta,
+    InvaderGamma,
+    InvaderKindCount
+};
+
+enum InvaderMovement {
+    MoveToSlot,     // fly to the formation slot and hold there
+    DiveFromSlot    // once in the slot, dive at the player every few seconds
+};
 
+// Everything that differs between invader kinds. Scoring and bomb timing are
+// lookups in this table, and InvaderArena steps each kind in its own loop.
+struct InvaderArchetype {
+    std::string texture;
+    float size;             // sprite is fitted to size x size pixels
+    int health;
+    float bombCooldown;     // seconds between drops
+    float bombSpeed;        // pixels per second
+    int score;
+    InvaderMovement movement;
+};
 
+inline const InvaderArchetype& invaderArchetype(InvaderKind kind) {
+    static const InvaderArchetype table[InvaderKindCount] = {
+        { "assets/alpha_invader.png", 50.f, 1, 5.f, 180.f, 10, MoveToSlot },
+        { "assets/beta_invader.png",  50.f, 2, 3.f, 180.f, 20, MoveToSlot },
+        { "assets/gamma_invader.png", 50.f, 2, 2.f, 220.f, 30, DiveFromSlot },
+    };
+    return table[kind];
+}
+
+// Binds the image and scales the sprite to a size x size box.
+inline std::shared_ptr<sf::Texture> fitSprite(sf::Sprite& sprite, const std::string& path, float size) {
+    auto texture = ResourceCache::instance().bindSprite(sprite, path);
+    sf::Vector2u texSize = ResourceCache::instance().getImageSize(path);
+    if (texSize.x > 0 && texSize.y > 0)
+        sprite.setScale(size / texSize.x, size / texSize.y);
+    return texture;
+}
+
+// A formation invader. Its kind only selects a row of the archetype table;
+// there are no subclasses, so every call on it is direct and inlinable.
+class Invader {
+private:
+    InvaderKind kind;
+    sf::Sprite sprite;
+    BoundsCache bounds;
+    sf::Vector2f previousPosition;   // position at the start of the last tick
+    sf::Vector2f targetPos;
+    float speed = 100.f;
+    bool aligned = false;
+    bool alive = true;
 
+    int health;
 
-        title.setFont(font);
-        title.setString("TOP 3 HIGH SCORES");
-        title.setCharacterSize(32);
-        title.setFillColor(sf::Color::White);
-        title.setPosition(220, 50);
+    std::shared_ptr<sf::Texture> texture;
 
-        goldBadgeTex.loadFromFile("assets/gold_badge.png");
-        silverBadgeTex.loadFromFile("assets/silver-badge.png");
-        bronzeBadgeTex.loadFromFile("assets/bronze_badge.png");
+    TimerWheel* timers = nullptr;
 
+    // DiveFromSlot only
+    bool isDiving = false;
+    bool diveDue = false;
+    TimerHandle diveHandle;
+    float diveInterval = 5.f;
+    float diveSpeed = 100.f;
+    float returnSpeed = 80.f;
+    float diveDelay = 1.f; // 13s, rolled in attach()
 
-        backText.setFont(font);
-        backText.setString("Press M to return to Menu");
-        backText.setCharacterSize(22);
-        backText.setFillColor(sf::Color::Yellow);
-        backText.setPosition(230, 500);
+    static void onDiveDue(void* owner, int) {
+        static_cast<Invader*>(owner)->diveDue = true;
     }
 
-    void handleEvents(sf::RenderWindow& window, GameState& state) override {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M)
-                state = GameState::Menu;
-        }
+    void scheduleDive() {
+        diveDue = false;
+        diveHandle = timers->scheduleIn(diveDelay + diveInterval, &Invader::onDiveDue, this);
     }
 
-    void update(GameState& state) override {
-        scoreTexts.clear();
-        badgeSprites.clear();
+    void moveToSlot(float dt) {
+        if (!aligned) {
+            sf::Vector2f dir = targetPos - sprite.getPosition();
+            float dist = std::sqrt(dir.x * dir.x + dir.y * dir.y);
+            if (dist < 1.f) {
+                sprite.setPosition(targetPos);
+                aligned = true;
+            }
+            else {
+                dir /= dist;
+                sprite.move(dir * speed * dt);
+            }
+        }
+    }
 
-        const auto& scores = manager.getScores();
+    void diveFromSlot(float dt) {
+        if (!aligned) {
+            moveToSlot(dt);
+            return;
+        }
 
-        if (scores.empty()) {
-            sf::Text emptyText;
-            emptyText.setFont(font);
-            emptyText.setCharacterSize(22);
-            emptyText.setFillColor(sf::Color::Red);
-            emptyText.setPosition(220, 200);
-            emptyText.setString("No high scores yet. Play to set one!");
-            scoreTexts.push_back(emptyText);
+        if (!isDiving && diveDue) {
+            isDiving = true;
+            diveDue = false;
         }
-        else {
-            for (size_t i = 0; i < scores.size(); ++i) {
-                const auto& p = scores[i];
 
-                // 1. Create text
-                sf::Text text;
-                text.setFont(font);
-                text.setCharacterSize(24);
-                text.setFillColor(sf::Color::White);
-                text.setPosition(150.f, 130.f + i * 50);
-                text.setString(p.getName() + " - " + to_string(p.getScore()));
-                scoreTexts.push_back(text);
-
-                // 2. Assign badge image
-                sf::Sprite badge;
-                if (i == 0) badge.setTexture(goldBadgeTex);
-                else if (i == 1) badge.setTexture(silverBadgeTex);
-                else badge.setTexture(bronzeBadgeTex);
-
-                badge.setScale(0.08f, 0.08f);
-                badge.setPosition(100.f, 130.f + i * 50);
-                badgeSprites.push_back(badge);
+        if (isDiving) {
+            if (sprite.getPosition().y < targetPos.y + 150.f) {
+                sprite.move(0, diveSpeed * dt);
+            }
+            else {
+                isDiving = false;
+                if (timers) scheduleDive();
             }
         }
+        else if (sprite.getPosition().y > targetPos.y) {
+            sprite.move(0, -returnSpeed * dt);
+        }
     }
 
+public:
+    Invader(InvaderKind invaderKind, sf::Vector2f startPos, sf::Vector2f target)
+        : kind(invaderKind), previousPosition(startPos), targetPos(target),
+          health(invaderArchetype(invaderKind).health)
+    {
+        texture = fitSprite(sprite, invaderArchetype(kind).texture, invaderArchetype(kind).size);
+        sprite.setPosition(startPos);
+    }
 
+    // Bookkeeping owned by BombScheduler.
+    struct BombSlot {
+        BombScheduler* scheduler = nullptr;
+        TimerHandle cooldown;
+        int readyIndex = -1;
+    } bombSlot;
 
-    void render(sf::RenderWindow& window) override {
-        window.clear();
-        window.draw(backgroundRect);
-        window.draw(title);
+    ~Invader() {
+        if (timers) timers->cancel(diveHandle);
+    }
 
-        for (size_t i = 0; i < scoreTexts.size(); ++i) {
-            window.draw(badgeSprites[i]);
-            window.draw(scoreTexts[i]);
+    // Hooks the invader up to the simulation's timer wheel and AI random stream.
+    // Called once, right after the invader joins the simulation.
+    void attach(TimerWheel& wheel, Pcg32& ai) {
+        timers = &wheel;
+        if (getArchetype().movement == DiveFromSlot) {
+            diveDelay = static_cast<float>(ai.range(1, 3));
+            scheduleDive();
         }
-        window.draw(backText);
-        window.display();
-
     }
-};
-//explosion
-class Explosion {
-private:
-    sf::Sprite sprite;
-    static sf::Texture sharedTexture;  // shared across all explosions
-    sf::Clock clock;
-    float duration = 0.6f;
-    bool finished = false;
 
-public:
-    Explosion(sf::Vector2f position, float scale = 0.08f) {
-        if (sharedTexture.getSize().x == 0) {
-            if (!sharedTexture.loadFromFile("assets/explosion2.png")) {
-                std::cerr << "[ERROR] Failed to load explosion texture\n";
-            }
-        }
-        sprite.setTexture(sharedTexture);
-        sprite.setPosition(position);
-        sprite.setScale(scale, scale);
+    // One tick for each movement rule; InvaderArena picks the rule per kind.
+    void stepToSlot(float dt) {
+        previousPosition = sprite.getPosition();
+        moveToSlot(dt);
+        if (sprite.getPosition() != previousPosition) bounds.markMoved();
     }
 
-    void update() {
-        if (clock.getElapsedTime().asSeconds() > duration) finished = true;
+    void stepDiving(float dt) {
+        previousPosition = sprite.getPosition();
+        diveFromSlot(dt);
+        if (sprite.getPosition() != previousPosition) bounds.markMoved();
     }
 
-    void draw(sf::RenderWindow& window) {
-        if (!finished) window.draw(sprite);
+    // Killed: stops its timers. The slot itself is reclaimed with the wave.
+    void retire() {
+        alive = false;
+        if (timers) timers->cancel(diveHandle);
     }
 
-    bool isFinished() const { return finished; }
-};
+    bool isAlive() const { return alive; }
 
-// Define static texture outside the class
-sf::Texture Explosion::sharedTexture;
+    void draw(SpriteBatch& batch, float alpha = 1.f) {
+        batch.add(sprite, interpolationOffset(previousPosition, sprite.getPosition(), alpha));
+    }
 
-//---------------------------------- Bullet ----------------------------------
-class Bullet {
-public:
-    sf::Sprite sprite;
-    sf::RectangleShape fallbackShape;
-    sf::Vector2f direction;
-    float speed;
-    bool useSprite = false;
+    const sf::FloatRect& getBounds() const {
+        return bounds.get(sprite);
+    }
 
-    Bullet(float x, float y, sf::Vector2f dir, sf::Texture* texture = nullptr)
-        : direction(dir), speed(10.f)
-    {
-        if (texture && texture->getSize().x > 0) {
-            sprite.setTexture(*texture);
-            sprite.setScale(0.05f, 0.05f); // Adjust based on your image size
-            sprite.setPosition(x, y);
-            useSprite = true;
-        }
-        else {
-            fallbackShape.setSize(sf::Vector2f(5.f, 15.f));
-            fallbackShape.setFillColor(sf::Color::Yellow);
-            fallbackShape.setPosition(x, y);
-        }
+    sf::Vector2f getBombPosition() const {
+        const sf::FloatRect& box = getBounds();
+        return { box.left + box.width / 2.f, box.top + box.height };
     }
 
-    void move() {
-        if (useSprite)
-            sprite.move(direction * speed);
-        else
-            fallbackShape.move(direction * speed);
+    sf::Vector2f getPosition() const {
+        return sprite.getPosition();
     }
 
-    void draw(sf::RenderWindow& window) {
-        if (useSprite)
-            window.draw(sprite);
-        else
-            window.draw(fallbackShape);
+    void setPosition(float x, float y) {
+        sprite.setPosition(x, y);
+        bounds.markMoved();
     }
 
-    sf::FloatRect getBounds() const {
-        return useSprite ? sprite.getGlobalBounds() : fallbackShape.getGlobalBounds();
+    bool isAligned() const { return aligned; }
+
+    void takeDamage() {
+        health--;
     }
 
-    sf::Vector2f getPosition() const {
-        return useSprite ? sprite.getPosition() : fallbackShape.getPosition();
+    bool isDead() const {
+        return health <= 0;
     }
+
+    InvaderKind getKind() const { return kind; }
+    const InvaderArchetype& getArchetype() const { return invaderArchetype(kind); }
+    float getBombCooldown() const { return getArchetype().bombCooldown; }
+    float getBombSpeed() const { return getArchetype().bombSpeed; }
+    int getScoreValue() const { return getArchetype().score; }
+
+    const sf::Sprite& getSprite() const { return sprite; }
 };
 
-//---------------------------------- Bomb (Invader Drop) ----------------------------------
-class Bomb {
+//----------------------------- Monster Invader -----------------------------
+class Monster {
 private:
+    enum BeamPhase { BeamCharged, BeamSpent };
     sf::Sprite sprite;
-    static sf::Texture texture;
-    float speed;
+    BoundsCache bounds;
+    BoundsCache beamBounds;
+    sf::Vector2f previousPosition;   // position at the start of the last tick
+    std::shared_ptr<sf::Texture> texture;
+    TimerWheel* timers = nullptr;
+    TimerHandle beamHandle;
+    bool isFiring = false;
+    float beamDuration = 1.0f;
+    float beamCooldown = 2.0f;
+    bool alreadyDodged = false;
 
-public:
-    Bomb(float x, float y, float spd = 100.f, sf::Texture* tex = nullptr)
-        : speed(spd)
-    {
-        if (tex && tex->getSize().x > 0) {
-            sprite.setTexture(*tex);
+    int health;
+    int maxHealth;
+    bool isMoving = true;
+
+    std::shared_ptr<sf::Texture> lightningTexture;
+    sf::Sprite lightningSprite;
+
+    sf::RectangleShape healthBarBack;
+    sf::RectangleShape healthBarFront;
+
+    float direction = 1.f;
+    float moveSpeed = 100.f;
+    float minX = 100.f;
+    float maxX = 600.f;
+
+    // Alternates between moving for beamCooldown and firing for beamDuration.
+    static void onBeamPhase(void* owner, int phase) {
+        Monster* m = static_cast<Monster*>(owner);
+        if (phase == BeamCharged) {
+            m->isMoving = false;
+            m->isFiring = true;
+            m->beamHandle = m->timers->scheduleIn(m->beamDuration, &Monster::onBeamPhase, m, BeamSpent);
         }
         else {
-            // fallback if texture fails
-            if (texture.getSize().x == 0)
-                texture.loadFromFile("assets/bomb.png");
-
-            sprite.setTexture(texture);
+            m->isFiring = false;
+            m->isMoving = true;
+            m->beamHandle = m->timers->scheduleIn(m->beamCooldown, &Monster::onBeamPhase, m, BeamCharged);
         }
-
-        sprite.setScale(0.03f, 0.03f);  // adjust size as needed
-        sprite.setPosition(x, y);
     }
 
-    void move() {
-        sprite.move(0.f, speed * (1.f / 60.f));
-    }
+    void update(float dt) {
+        // Update beam position
+        const sf::FloatRect& box = bounds.get(sprite);
+        float beamX = sprite.getPosition().x + box.width / 2.f - beamBounds.get(lightningSprite).width / 2.f;
+        float beamY = sprite.getPosition().y + box.height;
+        lightningSprite.setPosition(beamX, beamY);
+        beamBounds.markMoved();
 
-    void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
-    }
+        // Update health bar
+        sf::Vector2f pos = sprite.getPosition();
+        float width = box.width;
+        healthBarBack.setPosition(pos.x, pos.y - 10.f);
+        healthBarFront.setPosition(pos.x, pos.y - 10.f);
 
-    sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
-    }
+        float healthPercent = static_cast<float>(health) / maxHealth;
+        healthBarFront.setSize(sf::Vector2f(width * healthPercent, 8.f));
 
-    void setPosition(float x, float y) {
-        sprite.setPosition(x, y);
+        // Beam firing logic
+        if (isMoving) {
+            sprite.move(direction * moveSpeed * dt, 0.f);
+            bounds.markMoved();
+            if (sprite.getPosition().x < minX || sprite.getPosition().x > maxX) {
+                direction *= -1.f;
+            }
+        }
     }
 
-    sf::Vector2f getPosition() const {
-        return sprite.getPosition();
-    }
-};
+public:
+    Monster(sf::Vector2f pos) : previousPosition(pos)
+    {
+        texture = fitSprite(sprite, "assets/monster.png", 180.f);  // Monster texture
+        sprite.setPosition(pos);
 
-// ? define static texture outside the class
-sf::Texture Bomb::texture;
+        health = 30;
+        maxHealth = 30;
 
+        // Health bar setup
+        healthBarBack.setSize(sf::Vector2f(bounds.get(sprite).width, 8.f));
+        healthBarBack.setFillColor(sf::Color::Red);
 
-//---------------------------------- Spaceship ----------------------------------
-class Spaceship {
-public:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    float speed;
-    int lives;
-    bool isPoweredUp = false;
-    bool isOnFire = false;
-    sf::Clock powerClock, fireClock;
+        healthBarFront.setSize(sf::Vector2f(bounds.get(sprite).width, 8.f));
+        healthBarFront.setFillColor(sf::Color::Green);
 
-    Spaceship() {
-        if (!texture.loadFromFile("assets/sp.png")) {
-            cerr << "[ERROR] Could not load spaceship image.\n";
-        }
-        sprite.setTexture(texture);
-        sprite.setScale(0.10f, 0.10f); // Makes it smaller
-        sprite.setPosition(370.f, 500.f);
-        speed = 6.f;
-        lives = 3;
+        // Load lightning beam texture
+        lightningTexture = ResourceCache::instance().bindSprite(lightningSprite, "assets/lightning.png");
+        ResourceCache::instance().scaleSprite(lightningSprite, "assets/lightning.png", 0.1f, 0.7f);
     }
 
-    void move() {
-        sf::Vector2f movement(0.f, 0.f);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) movement.x -= speed;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) movement.x += speed;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) movement.y -= speed;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) movement.y += speed;
+    ~Monster() {
+        if (timers) timers->cancel(beamHandle);
+    }
 
-        sprite.move(movement);
+    Monster(const Monster&) = delete;
+    Monster& operator=(const Monster&) = delete;
 
-        // Wrap-around
-        sf::Vector2f pos = sprite.getPosition();
-        if (pos.x < -40) sprite.setPosition(800, pos.y);
-        if (pos.x > 800) sprite.setPosition(-40, pos.y);
-        if (pos.y < -40) sprite.setPosition(pos.x, 600);
-        if (pos.y > 600) sprite.setPosition(pos.x, -40);
+    void attach(TimerWheel& wheel, Pcg32& /*ai*/) {
+        timers = &wheel;
+        beamHandle = wheel.scheduleIn(beamCooldown, &Monster::onBeamPhase, this, BeamCharged);
+    }
 
-        if (isPoweredUp && powerClock.getElapsedTime().asSeconds() > 5) isPoweredUp = false;
-        if (isOnFire && fireClock.getElapsedTime().asSeconds() > 5) isOnFire = false;
+    void step(float dt) {
+        previousPosition = sprite.getPosition();
+        update(dt);
     }
 
-    void activatePowerUp() {
-        isPoweredUp = true;
-        powerClock.restart();
+    void draw(SpriteBatch& batch, float alpha = 1.f) {
+        sf::Vector2f offset = interpolationOffset(previousPosition, sprite.getPosition(), alpha);
+        batch.add(sprite, offset);
+        if (isFiring)
+            batch.add(lightningSprite, offset);  // draw the image-based lightning beam
+
+        batch.add(healthBarBack, offset);
+        batch.add(healthBarFront, offset);
     }
 
-    void activateFireMode() {
-        isOnFire = true;
-        fireClock.restart();
+    const sf::FloatRect& getBounds() const {
+        return bounds.get(sprite);
     }
 
-    sf::Vector2f getPosition() const {
-        return sprite.getPosition();
+    void takeDamage() {
+        health--;
     }
 
-    sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+    bool isDead() const {
+        return health <= 0;
     }
 
-    void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
+    sf::Vector2f getPosition() const {
+        return sprite.getPosition();
     }
-};
 
+    bool isBeamActive() const {
+        return isFiring;
+    }
 
-//---------------------------------- AddOn ----------------------------------
-class AddOn {
-protected:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    float speed = 2.f;
+    const sf::FloatRect& getBeamBounds() const {
+        return beamBounds.get(lightningSprite);  // updated to match sprite
+    }
 
-public:
-    virtual ~AddOn() {}
+    bool hasDodged() const {
+        return alreadyDodged;
+    }
 
-    virtual void fall() {
-        sprite.move(0, speed);
+    void markDodged() {
+        alreadyDodged = true;
     }
+};
 
-    virtual sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+//---------------------------------- InvaderArena ----------------------------------
+// Storage for one wave of invaders: per archetype, a list of fixed-size blocks
+// reserved once and reused by every wave, so building a formation never reaches
+// the general allocator after the first wave that needed that many. A full block
+// is never grown (timers and the bomb scheduler point into it); the next invader
+// starts another block instead. destroy() retires an invader where it stands and
+// the whole wave is freed at once by rewind(), after every invader is destroyed.
+// step() runs each archetype's blocks through one loop with its movement rule
+// fixed, skipping retired invaders.
+class InvaderArena {
+private:
+    static const size_t BlockSize = 64;     // one block holds any normal wave
+
+    // Moving a block's vector keeps its buffer, so growing `lanes` doesn't move
+    // any invader
+    std::vector<std::vector<Invader>> lanes[InvaderKindCount];
+    size_t used[InvaderKindCount] = {};     // blocks of each lane holding invaders
+    size_t live = 0;
+    size_t highWater = 0;                   // most invaders in one wave
+    size_t inWave = 0;
+
+    std::vector<Invader>& addBlock(std::vector<std::vector<Invader>>& lane) {
+        lane.emplace_back();
+        lane.back().reserve(BlockSize);
+        return lane.back();
     }
 
-    virtual void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
+public:
+    InvaderArena() {
+        for (auto& lane : lanes)
+            addBlock(lane);
+        for (auto& n : used)
+            n = 1;
     }
 
-    // Updated to support bullet parameter
-    virtual void applyEffect(Spaceship& player, int& score, GameState& state,
-        HighScoreManager& manager, const std::string& name,
-        std::vector<Bullet>& bullets) = 0;
+    InvaderArena(const InvaderArena&) = delete;
+    InvaderArena& operator=(const InvaderArena&) = delete;
 
-    virtual bool isDangerous() const { return false; }
+    Invader* create(InvaderKind kind, sf::Vector2f startPos, sf::Vector2f target) {
+        std::vector<std::vector<Invader>>& lane = lanes[kind];
+        std::vector<Invader>* block = &lane[used[kind] - 1];
+        if (block->size() == BlockSize) {
+            if (used[kind] == lane.size())
+                addBlock(lane);
+            block = &lane[used[kind]++];
+        }
+        block->emplace_back(kind, startPos, target);
+        live++;
+        highWater = std::max(highWater, ++inWave);
+        return &block->back();
+    }
 
-    virtual bool isOutOfScreen() const {
-        return sprite.getPosition().y > 600;
+    void destroy(Invader* invader) {
+        invader->retire();
+        live--;
     }
-};
 
-class PowerUpAddOn : public AddOn {
-public:
-    PowerUpAddOn(float x) {
-        if (!texture.loadFromFile("assets/powerUp.png")) {
-            std::cerr << "[ERROR] PowerUp texture not found.\n";
+    // Empties every block but keeps them, so the next wave of the same size
+    // fits without allocating.
+    void rewind() {
+        for (int k = 0; k < InvaderKindCount; ++k) {
+            for (auto& block : lanes[k])
+                block.clear();
+            used[k] = 1;
         }
-        sprite.setTexture(texture);
-        sprite.setScale(0.05f, 0.05f);
-        sprite.setPosition(x, 0.f);
+        inWave = 0;
     }
-        void applyEffect(Spaceship& player, int& score, GameState&,
-            HighScoreManager&, const std::string&,
-            std::vector<Bullet>&) override
-        {
-            player.activatePowerUp();
-            // No bullets here any more!
-        }
-    };
 
-class ExtraLifeAddOn : public AddOn {
-public:
-    ExtraLifeAddOn(float x) {
-        if (!texture.loadFromFile("assets/extra_life.png")) {
-            std::cerr << "[ERROR] ExtraLife texture not found.\n";
+    void step(float dt) {
+        for (int k = 0; k < InvaderKindCount; ++k) {
+            const bool diving = invaderArchetype(static_cast<InvaderKind>(k)).movement == DiveFromSlot;
+            for (size_t b = 0; b < used[k]; ++b) {
+                std::vector<Invader>& block = lanes[k][b];
+                if (diving) {
+                    for (Invader& e : block)
+                        if (e.isAlive()) e.stepDiving(dt);
+                }
+                else {
+                    for (Invader& e : block)
+                        if (e.isAlive()) e.stepToSlot(dt);
+                }
+            }
         }
-        sprite.setTexture(texture);
-        sprite.setScale(0.04f, 0.04f);
-        sprite.setPosition(x, 0.f);
     }
 
-    void applyEffect(Spaceship& player, int& score, GameState&, HighScoreManager&, const std::string&, std::vector<Bullet>&) override {
-        player.lives++;
+    size_t getLiveCount() const { return live; }
+    size_t getHighWater() const { return highWater; }
+
+    size_t getBlockCount() const {
+        size_t n = 0;
+        for (const auto& lane : lanes)
+            n += lane.size();
+        return n;
     }
+
+    size_t getCapacity() const { return getBlockCount() * BlockSize; }
 };
 
-class DangerAddOn : public AddOn {
+//-----------------------------Screen Base-Class----------------------------
+// Screens are handed their events one at a time by ScreenManager, which only
+// calls render() when the screen is dirty or animating; otherwise it blocks in
+// waitEvent() and the process sleeps until there is input.
+class Screen {
+private:
+    bool dirty = true;
+
 public:
-    DangerAddOn(float x) {
-        if (!texture.loadFromFile("assets/danger_sign.png")) {
-            std::cerr << "[ERROR] DangerSign texture not found.\n";
-        }
-        sprite.setTexture(texture);
-        sprite.setScale(0.008f, 0.008f);
-        sprite.setPosition(x, 0.f);
-    }
+    virtual void handleEvent(const sf::Event& event, GameState& state) = 0;
+    virtual void update(GameState& state) = 0;
+    virtual void render(sf::RenderWindow& window) = 0;
 
-    void applyEffect(Spaceship& player, int& score, GameState&, HighScoreManager&, const std::string&, std::vector<Bullet>&) override {
-        player.lives--;
-    }
+    // True while the screen changes without input and must be redrawn every frame.
+    virtual bool isAnimating() const { return false; }
 
-    bool isDangerous() const override { return true; }
+    void markDirty() { dirty = true; }
+    bool isDirty() const { return dirty; }
+    void clearDirty() { dirty = false; }
+
+    virtual ~Screen() {}
 };
 
-//-----------------------------levelManager-----------------------------
-class LevelManager {
+//--------------------MenuScreen----------------------------------------
+class MenuScreen final : public Screen {
 private:
-    int currentLevel = 1;
-    int currentWave = 1;
+    std::shared_ptr<sf::Texture> backgroundTexture;
+    sf::Sprite backgroundSprite;
 
-public:
-    bool waveJustChanged = false;
-    int getLevel() const { return currentLevel; }
-    int getWave() const { return currentWave; }
+    std::shared_ptr<sf::Texture> logoTexture;
+    sf::Sprite logoSprite;
 
-    void advanceWave() {
-        int maxWaves = getWavesForCurrentLevel();
+    std::shared_ptr<sf::Font> font;
+    sf::Text title, playText, instructionsText, highScoreText;
 
-        currentWave++;
-        if (currentWave > maxWaves) {
-            currentWave = 1;
-            currentLevel++;
-        }
-    }
 
-    int getWavesForCurrentLevel() const {
-        if (currentLevel == 1 || currentLevel == 2) return 3;
-        if (currentLevel == 3) return 3; // we removed old wave 3
-        return 0;
-    }
-    //rectangle
-    void createWave1(std::vector<Invader*>& invaders) {
-        const int rows = 4;
-        const int cols = 10;
-        const float spacingX = 60.f;
-        const float spacingY = 60.f;
+public:
+    MenuScreen() {
+        // Load Background
+        backgroundTexture = ResourceCache::instance().getTexture("assets/menu_bg.png");
+        backgroundSprite.setTexture(*backgroundTexture);
 
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                if (row == 0 || row == rows - 1 || col == 0 || col == cols - 1) {
-                    sf::Vector2f startPos(-50.f, 50.f + row * spacingY);
-                    sf::Vector2f targetPos(100.f + col * spacingX, 50.f + row * spacingY);
-                    invaders.push_back(new AlphaInvader(startPos, targetPos));
+        // Load Logo
+        logoTexture = ResourceCache::instance().getTexture("assets/space_logo.png");
+        logoSprite.setTexture(*logoTexture);
+        logoSprite.setScale(0.55f, 0.55f);
+        logoSprite.setPosition(190.f, 50.f);
+
+        font = ResourceCache::instance().getFont("assets/impact.ttf");
+
+        playText.setFont(*font);
+        playText.setString("Play");
+        playText.setCharacterSize(30);
+        playText.setFillColor(sf::Color::Green);
+        playText.setPosition(290, 300);
+        playText.setOutlineColor(sf::Color::Black);
+        playText.setOutlineThickness(2);
+
+
+        instructionsText.setFont(*font);
+        instructionsText.setString("Instructions");
+        instructionsText.setCharacterSize(30);
+        instructionsText.setFillColor(sf::Color::Yellow);
+        instructionsText.setPosition(290, 350);
+        instructionsText.setOutlineColor(sf::Color::Black);
+        instructionsText.setOutlineThickness(2);
+
+        highScoreText.setFont(*font);
+        highScoreText.setString("High Scores");
+        highScoreText.setCharacterSize(30);
+        highScoreText.setFillColor(sf::Color::Cyan);
+        highScoreText.setPosition(290, 400);
+        highScoreText.setOutlineColor(sf::Color::Black);
+        highScoreText.setOutlineThickness(2);
+
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        // Mouse click handling
+        if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.mouseButton.button == sf::Mouse::Left) {
+                sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+
+                if (playText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::NameInput;
+                }
+                else if (instructionsText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::Instructions;
+                }
+                else if (highScoreText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::HighScore;
+                }
+            }
+        }
+    }
+
+    void update(GameState& state) override {
+
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundSprite);
+        window.draw(logoSprite);
+        window.draw(playText);
+        window.draw(instructionsText);
+        window.draw(highScoreText);
+        window.display();
+
+    }
+};
+//--------------------InstructionScreen----------------------------------------
+class InstructionScreen final : public Screen {
+private:
+    std::shared_ptr<sf::Font> font;
+    sf::Text  header, controls, tips, returnText;
+    std::shared_ptr<sf::Texture> backgroundTexture;
+    sf::Sprite backgroundSprite;
+
+    sf::Clock blinkClock;   // For blinking/fading animation
+
+public:
+    InstructionScreen() {
+        font = ResourceCache::instance().getFont("assets/impact.ttf");
+        backgroundTexture = ResourceCache::instance().getTexture("assets/b2.png");
+        backgroundSprite.setTexture(*backgroundTexture);
+        backgroundSprite.setScale(
+            800.f / backgroundTexture->getSize().x,
+            600.f / backgroundTexture->getSize().y
+        );
+        //header section
+        header.setFont(*font);
+        header.setString("MISSION BRIEFING");
+        header.setCharacterSize(42);
+        header.setFillColor(sf::Color(0, 255, 255));
+        header.setOutlineColor(sf::Color(0, 150, 255));
+        header.setOutlineThickness(3);
+        header.setPosition(220.f, 40.f);
+
+        //controls section
+        controls.setFont(*font);
+        controls.setCharacterSize(22);
+        controls.setFillColor(sf::Color::White);
+        controls.setOutlineColor(sf::Color(0, 100, 200));
+        controls.setOutlineThickness(2);
+        controls.setString(
+            "Controls:\n"
+            "  ? Move Up:         W\n"
+            "  ? Move Down:    S\n"
+            "  ? Move Left:       A\n"
+            "  ? Move Right:     D\n"
+            "  ? Shoot:           Spacebar\n"
+            "  ? Pause:           Escape"
+        );
+        controls.setPosition(100.f, 100.f);
+
+        //tips section
+        tips.setFont(*font);
+        tips.setCharacterSize(22);
+        tips.setFillColor(sf::Color::White);
+        tips.setOutlineColor(sf::Color(0, 100, 200));
+        tips.setOutlineThickness(2);
+
+        tips.setString(
+            "Tips:\n"
+            "   Avoid Invader fire.\n"
+            "   Collect power-ups.\n"
+            "   Earn high scores to win badges!"
+        );
+        tips.setPosition(100.f, 300.f);
+
+        //Press M to Return Prompt
+        returnText.setFont(*font);
+        returnText.setCharacterSize(22);
+        returnText.setString("? Back");
+        returnText.setPosition(16.f, 20.f);
+        returnText.setStyle(sf::Text::Italic);
+        returnText.setFillColor(sf::Color::White);
+        returnText.setOutlineThickness(2);
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.mouseButton.button == sf::Mouse::Left) {
+                sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+
+                if (returnText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::Menu;
+                }
+            }
+        }
+    }
+
+    void update(GameState& state) override {
+         
+
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundSprite);
+        window.draw(header);
+        window.draw(controls);
+        window.draw(tips);
+        window.draw(returnText);
+        window.display();
+
+    }
+};
+//--------------------PauseScreen----------------------------------------
+class PauseScreen final : public Screen {
+private:
+    std::shared_ptr<sf::Font> font;
+    std::shared_ptr<sf::Texture> backgroundTexture;
+    sf::Sprite backgroundSprite;
+
+    sf::Text pauseTitle, resumeText, quitText;
+
+
+public:
+    PauseScreen() {
+
+        font = ResourceCache::instance().getFont("assets/impact.ttf");
+        backgroundTexture = ResourceCache::instance().getTexture("assets/b5.jpg");
+
+        backgroundSprite.setTexture(*backgroundTexture);
+        backgroundSprite.setScale(800.f / backgroundTexture->getSize().x, 600.f / backgroundTexture->getSize().y);
+
+        pauseTitle.setFont(*font);
+        pauseTitle.setString("GAME PAUSED");
+        pauseTitle.setCharacterSize(60);
+        pauseTitle.setFillColor(sf::Color(217, 130, 7));
+        pauseTitle.setOutlineColor(sf::Color::Black);
+        pauseTitle.setOutlineThickness(3);
+        pauseTitle.setPosition(220.f, 150.f);
+
+        resumeText.setFont(*font);
+        resumeText.setString("Resume");
+        resumeText.setCharacterSize(26);
+        resumeText.setFillColor(sf::Color(245, 197, 108));
+        resumeText.setOutlineColor(sf::Color::Black);
+        resumeText.setPosition(250.f, 260.f);
+
+        quitText.setFont(*font);
+        quitText.setString("Quit");
+        quitText.setCharacterSize(26);
+        quitText.setFillColor(sf::Color(184, 126, 18));
+        quitText.setOutlineColor(sf::Color::Black);
+        quitText.setPosition(220.f, 310.f);
+
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.mouseButton.button == sf::Mouse::Left) {
+                sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+                if (resumeText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::Playing;
+                }
+                else if (quitText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::Menu;
+                }
+            }
+        }
+    }
+
+    void update(GameState& state) override {
+
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundSprite);
+
+        sf::RectangleShape overlay(sf::Vector2f(800.f, 600.f));
+        overlay.setFillColor(sf::Color(0, 0, 0, 130));
+        window.draw(overlay);
+
+        window.draw(pauseTitle);
+        window.draw(resumeText);
+        window.draw(quitText);
+        window.display();
+    }
+};
+
+//------------------------GamePlayScreen---------------------------
+class GamePlayScreen : public Screen {
+private:
+    sf::RectangleShape player;
+    float speed = 200.0f; // pixels per second
+
+public:
+    GamePlayScreen() {
+        player.setSize(sf::Vector2f(50, 50));
+        player.setFillColor(sf::Color::Cyan);
+        player.setPosition(375, 500);
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::Escape)
+                state = GameState::Menu;
+        }
+    }
+
+    bool isAnimating() const override { return true; }
+
+    void update(GameState& state) override {
+        float dt = 1.0f / 60.0f;
+
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+            player.move(-speed * dt, 0);
+        }
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+            player.move(speed * dt, 0);
+        }
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear(sf::Color::Black);
+        window.draw(player);
+        window.display();
+    }
+};
+//---------------------------------GameOverScreen----------------------------
+class GameOverScreen final : public Screen {
+private:
+    std::shared_ptr<sf::Font> font;
+    sf::Text gameOverText, scoreText, backText;
+    sf::RectangleShape backgroundRect;
+    int finalScore = 0;
+
+public:
+    GameOverScreen() {
+        font = ResourceCache::instance().getFont("assets/Orbitron-Regular.ttf");
+
+        // Background
+        backgroundRect.setSize(sf::Vector2f(800.f, 600.f));
+        backgroundRect.setFillColor(sf::Color(26, 3, 94));
+
+        // GAME OVER Title
+        gameOverText.setFont(*font);
+        gameOverText.setString("GAME OVER");
+        gameOverText.setCharacterSize(40);
+        gameOverText.setFillColor(sf::Color(230, 230, 250));
+        gameOverText.setOutlineColor(sf::Color(0, 100, 255));
+        gameOverText.setOutlineThickness(3);
+        gameOverText.setPosition(220, 120);
+
+        // Final Score
+        scoreText.setFont(*font);
+        scoreText.setCharacterSize(24);
+        scoreText.setFillColor(sf::Color(180, 220, 255));
+        scoreText.setOutlineColor(sf::Color::Black);
+        scoreText.setOutlineThickness(1.5f);
+        scoreText.setPosition(250, 220);
+
+        // Menu Prompt
+        backText.setFont(*font);
+        backText.setString("Back to Menu");
+        backText.setCharacterSize(20);
+        backText.setFillColor(sf::Color::White);
+        backText.setOutlineColor(sf::Color(0, 120, 255));
+        backText.setOutlineThickness(2);
+        backText.setStyle(sf::Text::Italic);
+        backText.setPosition(200, 320);
+    }
+
+    void setFinalScore(int score) {
+        finalScore = score;
+        ScratchString s = scratchString("Final Score: ");
+        scoreText.setString(appendNumber(s, score).c_str());
+        markDirty();
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.mouseButton.button == sf::Mouse::Left) {
+                sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
+
+                if (backText.getGlobalBounds().contains(mousePos)) {
+                    state = GameState::Menu;
+                }
+            }
+        }
+    }
+
+    void update(GameState& state) override {
+        // Nothing for now
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundRect);
+        window.draw(gameOverText);
+        window.draw(scoreText);
+        window.draw(backText);
+        window.display();
+    }
+};
+
+//-------------------------NameInputScreen----------------------------------------
+class NameInputScreen final : public Screen {
+private:
+    std::shared_ptr<sf::Font> font;
+    sf::Text promptText, nameText, infoText, subtitle;
+    std::string playerName;
+    std::shared_ptr<sf::Texture> backgroundTexture;
+    sf::Sprite backgroundSprite;
+    sf::Clock cursorClock, fadeClock;
+    ;
+    sf::RectangleShape underline;
+    bool showCursor = true;
+    bool showWarning = false;
+    sf::Text warningText;
+
+
+
+public:
+    NameInputScreen() {
+        font = ResourceCache::instance().getFont("assets/impact.ttf");
+        backgroundTexture = ResourceCache::instance().getTexture("assets/b4.jpg");
+        backgroundSprite.setScale(
+            800.f / backgroundTexture->getSize().x,
+            600.f / backgroundTexture->getSize().y
+        );
+        backgroundSprite.setTexture(*backgroundTexture);
+
+
+
+        underline.setSize(sf::Vector2f(250.f, 2.f));
+        underline.setFillColor(sf::Color(255, 200, 90));
+        underline.setPosition(30.f, 180.f);
+
+        promptText.setFont(*font);
+        promptText.setString("ENTER YOUR CALLSIGN");
+        promptText.setCharacterSize(28);
+        promptText.setPosition(20.f, 90.f);
+        promptText.setFillColor(sf::Color(207, 154, 8));
+        promptText.setStyle(sf::Text::Bold);
+        promptText.setOutlineColor(sf::Color::Black);
+        promptText.setOutlineThickness(2);
+        ;
+        subtitle.setFont(*font);
+        subtitle.setString("Press ENTER to initiate mission");
+        subtitle.setCharacterSize(16);
+        subtitle.setFillColor(sf::Color(200, 200, 200));
+        subtitle.setPosition(200, 350);
+
+
+        nameText.setFont(*font);
+        nameText.setCharacterSize(24);
+        nameText.setFillColor(sf::Color(255, 235, 140));
+        nameText.setPosition(30.f, 156.f);
+        nameText.setOutlineColor(sf::Color::Black);
+        nameText.setOutlineThickness(1.5f);
+
+        infoText.setFont(*font);
+        infoText.setCharacterSize(23);
+        infoText.setFillColor(sf::Color::Yellow);
+        infoText.setString("Press Enter to start playing");
+        infoText.setPosition(40, 215);
+
+        warningText.setFont(*font); // use your existing font
+        warningText.setCharacterSize(20);
+        warningText.setFillColor(sf::Color::Red);
+        warningText.setString("Please enter your callsign!");
+        warningText.setPosition(200.f, 300.f); // adjust as needed
+
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::TextEntered) {
+            if (event.text.unicode == '\b' && !playerName.empty()) {
+                playerName.pop_back();
+                showWarning = false;
+            }
+            else if (event.text.unicode >= 32 && event.text.unicode < 128) {
+                playerName += static_cast<char>(event.text.unicode);
+                showWarning = false;
+            }
+        }
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
+            if (!playerName.empty()) {
+                state = GameState::Playing;
+                showWarning = false;
+            }
+            else {
+                showWarning = true; // Show the warning message
+            }
+        }
+    }
+
+
+    void update(GameState& state) override {
+        if (cursorClock.getElapsedTime().asSeconds() > 0.5f) {
+            showCursor = !showCursor;
+            cursorClock.restart();
+        }
+        int alpha = static_cast<int>(std::abs(std::sin(fadeClock.getElapsedTime().asSeconds() * 2)) * 255);
+        infoText.setFillColor(sf::Color(255, 220, 150, alpha));
+
+        std::string displayName = playerName + (showCursor ? "|" : " ");
+        nameText.setString(displayName);
+    }
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundSprite);
+        window.draw(promptText);
+        window.draw(nameText);
+        window.draw(underline);
+        window.draw(infoText);
+        if (showWarning) {
+            window.draw(warningText); 
+        }
+        window.display();
+    }
+
+    bool isAnimating() const override { return true; }
+
+    const std::string& getPlayerName() const {
+        return playerName;
+    }
+};
+
+//--------------------------------PlayerScore---------------------
+class PlayerScore {
+private:
+    string name;
+    int score;
+    string badge;
+
+public:
+    PlayerScore() : name(""), score(0), badge("None") {}
+    PlayerScore(string n, int s, string b = "None")
+        : name(n), score(s), badge(b) {
+    }
+
+    const string& getName() const { return name; }
+    int getScore() const { return score; }
+    const string& getBadge() const { return badge; }
+
+    void setBadge(const string& b) { badge = b; }
+
+    bool operator<(const PlayerScore& other) const {
+        return score > other.score;
+    }
+
+    string toLine() const {
+        return name + " " + to_string(score) + " " + badge;
+    }
+    static PlayerScore fromLine(const string& line) {
+        istringstream iss(line);
+        string n, b;
+        int s = 0;
+        iss >> n >> s >> b;
+        return PlayerScore(n, s, b);
+    }
+};
+
+//-----------------HighScoreManager------------------------------------------
+class HighScoreManager {
+private:
+    string fileName;
+    vector<PlayerScore> scores;
+    unsigned version = 0;   // bumped whenever the score list changes
+
+public:
+    HighScoreManager(string file = "highscores.txt") : fileName(file) {
+        loadFromFile();
+    }
+
+    void loadFromFile() {
+        scores.clear();
+        version++;
+
+        ifstream in(fileName);
+        if (!in.is_open()) {
+            // File doesnt exist yet  create empty one
+            ofstream out(fileName);
+            out.close();
+            return;
+        }
+
+        string line;
+        while (getline(in, line)) {
+            if (!line.empty()) {
+                scores.push_back(PlayerScore::fromLine(line));
+            }
+        }
+
+        in.close();
+    }
+
+
+    void saveToFile() {
+        ofstream out(fileName);
+        for (auto& s : scores) {
+            out << s.toLine() << "\n";
+        }
+        out.close();
+    }
+
+    void addNewScore(const string& name, int score) {
+        scores.push_back(PlayerScore(name, score));
+        sort(scores.begin(), scores.end());
+
+        if (scores.size() > 3)
+            scores.resize(3);
+
+        assignBadges();
+        saveToFile();
+        version++;
+
+    }
+
+    void assignBadges() {
+        for (size_t i = 0; i < scores.size(); ++i) {
+            if (i == 0) scores[i].setBadge("Gold");
+            else if (i == 1) scores[i].setBadge("Silver");
+            else if (i == 2) scores[i].setBadge("Bronze");
+            else scores[i].setBadge("None");
+        }
+    }
+
+    const vector<PlayerScore>& getScores() const {
+        return scores;
+    }
+
+    unsigned getVersion() const { return version; }
+};
+
+//---------------------------- HighScoreScreen ----------------------------
+class HighScoreScreen final : public Screen {
+private:
+    std::shared_ptr<sf::Font> font;
+    sf::Text title, backText;
+    sf::RectangleShape backgroundRect;
+
+    std::shared_ptr<sf::Texture> goldBadgeTex, silverBadgeTex, bronzeBadgeTex;
+    std::vector<sf::Sprite> badgeSprites;
+
+    vector<sf::Text> scoreTexts;
+    HighScoreManager& manager;
+    unsigned shownVersion = 0;
+    bool built = false;
+
+public:
+    HighScoreScreen(HighScoreManager& mgr) : manager(mgr) {
+        font = ResourceCache::instance().getFont("assets/Orbitron-Regular.ttf");
+
+        backgroundRect.setSize(sf::Vector2f(800.f, 600.f));  // Full window
+        backgroundRect.setFillColor(sf::Color(26, 3, 94));  // Custom RGB color
+
+
+
+
+        title.setFont(*font);
+        title.setString("TOP 3 HIGH SCORES");
+        title.setCharacterSize(32);
+        title.setFillColor(sf::Color::White);
+        title.setPosition(220, 50);
+
+        goldBadgeTex = ResourceCache::instance().getTexture("assets/gold_badge.png");
+        silverBadgeTex = ResourceCache::instance().getTexture("assets/silver-badge.png");
+        bronzeBadgeTex = ResourceCache::instance().getTexture("assets/bronze_badge.png");
+
+
+        backText.setFont(*font);
+        backText.setString("Press M to return to Menu");
+        backText.setCharacterSize(22);
+        backText.setFillColor(sf::Color::Yellow);
+        backText.setPosition(230, 500);
+    }
+
+    void handleEvent(const sf::Event& event, GameState& state) override {
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M)
+            state = GameState::Menu;
+    }
+
+    // Rebuilds the rows only when the score list has changed.
+    void update(GameState& state) override {
+        if (built && manager.getVersion() == shownVersion)
+            return;
+        built = true;
+        shownVersion = manager.getVersion();
+        markDirty();
+        scoreTexts.clear();
+        badgeSprites.clear();
+
+        const auto& scores = manager.getScores();
+
+        if (scores.empty()) {
+            sf::Text emptyText;
+            emptyText.setFont(*font);
+            emptyText.setCharacterSize(22);
+            emptyText.setFillColor(sf::Color::Red);
+            emptyText.setPosition(220, 200);
+            emptyText.setString("No high scores yet. Play to set one!");
+            scoreTexts.push_back(emptyText);
+        }
+        else {
+            for (size_t i = 0; i < scores.size(); ++i) {
+                const auto& p = scores[i];
+
+                // 1. Create text
+                sf::Text text;
+                text.setFont(*font);
+                text.setCharacterSize(24);
+                text.setFillColor(sf::Color::White);
+                text.setPosition(150.f, 130.f + i * 50);
+                ScratchString row = scratchString(p.getName().c_str());
+                row.append(" - ");
+                text.setString(appendNumber(row, p.getScore()).c_str());
+                scoreTexts.push_back(text);
+
+                // 2. Assign badge image
+                sf::Sprite badge;
+                if (i == 0) badge.setTexture(*goldBadgeTex);
+                else if (i == 1) badge.setTexture(*silverBadgeTex);
+                else badge.setTexture(*bronzeBadgeTex);
+
+                badge.setScale(0.08f, 0.08f);
+                badge.setPosition(100.f, 130.f + i * 50);
+                badgeSprites.push_back(badge);
+            }
+        }
+    }
+
+
+
+    void render(sf::RenderWindow& window) override {
+        window.clear();
+        window.draw(backgroundRect);
+        window.draw(title);
+
+        for (size_t i = 0; i < scoreTexts.size(); ++i) {
+            window.draw(badgeSprites[i]);
+            window.draw(scoreTexts[i]);
+        }
+        window.draw(backText);
+        window.display();
+
+    }
+};
+//explosion
+class Explosion {
+private:
+    sf::Sprite sprite;
+    std::shared_ptr<sf::Texture> texture;  // shared across all explosions
+    uint64_t expiresAt;    // simulation tick after which it is removed
+
+public:
+    static constexpr float Duration = 0.6f;
+
+    Explosion(sf::Vector2f position, uint64_t expiryTick, float scale = 0.08f)
+        : expiresAt(expiryTick)
+    {
+        static const std::string path = "assets/explosion2.png";
+        texture = ResourceCache::instance().bindSprite(sprite, path);
+        sprite.setPosition(position);
+        ResourceCache::instance().scaleSprite(sprite, path, scale, scale);
+    }
+
+    void draw(SpriteBatch& batch) {
+        batch.add(sprite);
+    }
+
+    bool isFinished(uint64_t now) const { return now > expiresAt; }
+};
+
+//---------------------------------- Collision kernel ----------------------------------
+// Batch AABB tests: one query box against many boxes stored as min/max arrays.
+// Every variant gives bit-for-bit the answer of sf::FloatRect::intersects: the
+// boxes are normalised the same way and overlap is the same strict
+// max(min) < min(max) test, just done 4 or 8 boxes at a time.
+#if defined(__AVX2__)
+static const char* const CollisionKernelName = "avx2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLLISION_SSE2
+static const char* const CollisionKernelName = "sse2";
+#else
+static const char* const CollisionKernelName = "scalar";
+#endif
+
+// One bit per box, set where the box overlaps the query.
+struct HitMask {
+    std::vector<uint64_t> words;
+
+    void reset(size_t boxes) { words.assign((boxes + 63) / 64, 0); }
+
+    bool test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+    bool any() const {
+        for (uint64_t w : words)
+            if (w) return true;
+        return false;
+    }
+
+    // Index of the lowest set bit, or -1.
+    int first() const {
+        for (size_t w = 0; w < words.size(); ++w)
+            if (words[w])
+                return static_cast<int>(w * 64 + lowestBit(words[w]));
+        return -1;
+    }
+
+    // Calls fn(i) for every set bit in ascending order.
+    template<class F>
+    void forEach(F fn) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            uint64_t bits = words[w];
+            while (bits) {
+                fn(w * 64 + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    static unsigned lowestBit(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, v);
+        return static_cast<unsigned>(idx);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+    }
+};
+
+// Boxes as normalised min/max coordinate arrays. Storage is padded with empty
+// boxes to a whole number of blocks, so the kernels never need a scalar tail.
+class BoxSoA {
+public:
+    static const size_t Block = 8;
+
+private:
+    std::vector<float> minX, minY, maxX, maxY;
+    size_t count = 0;
+
+public:
+    void clear() {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+        count = 0;
+    }
+
+    void push(const sf::FloatRect& r) {
+        // A zero-area box at the origin can never satisfy min < max, so the
+        // padding never reports a hit
+        if (count == minX.size()) {
+            minX.resize(count + Block, 0.f);
+            minY.resize(count + Block, 0.f);
+            maxX.resize(count + Block, 0.f);
+            maxY.resize(count + Block, 0.f);
+        }
+        const float right = r.left + r.width;
+        const float bottom = r.top + r.height;
+        minX[count] = std::min(r.left, right);
+        maxX[count] = std::max(r.left, right);
+        minY[count] = std::min(r.top, bottom);
+        maxY[count] = std::max(r.top, bottom);
+        ++count;
+    }
+
+    // Turns box i into padding so it stops reporting hits.
+    void disable(size_t i) {
+        minX[i] = minY[i] = maxX[i] = maxY[i] = 0.f;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t paddedSize() const { return minX.size(); }
+
+    friend void intersectScalar(const sf::FloatRect&, const BoxSoA&, HitMask&);
+    friend void intersectBatch(const sf::FloatRect&, const BoxSoA&, HitMask&);
+};
+
+// Reference version, one box at a time. Kept for targets without SIMD and as
+// the baseline in --bench-collide.
+inline void intersectScalar(const sf::FloatRect& box, const BoxSoA& boxes, HitMask& hits) {
+    hits.reset(boxes.paddedSize());
+    const float qx0 = std::min(box.left, box.left + box.width);
+    const float qx1 = std::max(box.left, box.left + box.width);
+    const float qy0 = std::min(box.top, box.top + box.height);
+    const float qy1 = std::max(box.top, box.top + box.height);
+
+    for (size_t i = 0; i < boxes.count; ++i) {
+        if (std::max(qx0, boxes.minX[i]) < std::min(qx1, boxes.maxX[i]) &&
+            std::max(qy0, boxes.minY[i]) < std::min(qy1, boxes.maxY[i]))
+            hits.words[i / 64] |= uint64_t(1) << (i % 64);
+    }
+}
+
+// Sets bit i of `hits` when box i overlaps `box`. Uses the widest kernel the
+// build targets (compile with -mavx2 or /arch:AVX2 for the 8-wide one).
+inline void intersectBatch(const sf::FloatRect& box, const BoxSoA& boxes, HitMask& hits) {
+#if defined(__AVX2__) || defined(COLLISION_SSE2)
+    hits.reset(boxes.paddedSize());
+    const float qx0 = std::min(box.left, box.left + box.width);
+    const float qx1 = std::max(box.left, box.left + box.width);
+    const float qy0 = std::min(box.top, box.top + box.height);
+    const float qy1 = std::max(box.top, box.top + box.height);
+    const size_t n = boxes.paddedSize();
+
+#if defined(__AVX2__)
+    const __m256 ax0 = _mm256_set1_ps(qx0), ax1 = _mm256_set1_ps(qx1);
+    const __m256 ay0 = _mm256_set1_ps(qy0), ay1 = _mm256_set1_ps(qy1);
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 left = _mm256_max_ps(_mm256_loadu_ps(&boxes.minX[i]), ax0);
+        __m256 right = _mm256_min_ps(_mm256_loadu_ps(&boxes.maxX[i]), ax1);
+        __m256 top = _mm256_max_ps(_mm256_loadu_ps(&boxes.minY[i]), ay0);
+        __m256 bottom = _mm256_min_ps(_mm256_loadu_ps(&boxes.maxY[i]), ay1);
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(left, right, _CMP_LT_OQ),
+            _mm256_cmp_ps(top, bottom, _CMP_LT_OQ));
+        hits.words[i / 64] |= uint64_t(_mm256_movemask_ps(hit)) << (i % 64);
+    }
+#else
+    const __m128 ax0 = _mm_set1_ps(qx0), ax1 = _mm_set1_ps(qx1);
+    const __m128 ay0 = _mm_set1_ps(qy0), ay1 = _mm_set1_ps(qy1);
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 left = _mm_max_ps(_mm_loadu_ps(&boxes.minX[i]), ax0);
+        __m128 right = _mm_min_ps(_mm_loadu_ps(&boxes.maxX[i]), ax1);
+        __m128 top = _mm_max_ps(_mm_loadu_ps(&boxes.minY[i]), ay0);
+        __m128 bottom = _mm_min_ps(_mm_loadu_ps(&boxes.maxY[i]), ay1);
+        __m128 hit = _mm_and_ps(_mm_cmplt_ps(left, right), _mm_cmplt_ps(top, bottom));
+        hits.words[i / 64] |= uint64_t(_mm_movemask_ps(hit)) << (i % 64);
+    }
+#endif
+#else
+    intersectScalar(box, boxes, hits);
+#endif
+}
+
+//---------------------------------- BulletSystem ----------------------------------
+// All player bullets in structure-of-arrays form: positions, directions and alive
+// flags live in parallel contiguous arrays so integration and culling are tight,
+// vectorizable loops. Sprite geometry is only generated in draw().
+class BulletSystem {
+private:
+    std::vector<float> posX, posY;
+    std::vector<float> prevX, prevY;    // positions before the last integrate()
+    std::vector<float> dirX, dirY;
+    std::vector<unsigned char> alive;
+
+    const sf::Texture* texture = nullptr;
+    sf::IntRect textureRect;                // the bullet image within texture
+    sf::Vector2f bulletSize{ 5.f, 15.f };   // fallback rectangle size
+    float speed = 600.f;                // pixels per second
+    float spriteScale = 0.05f;
+
+public:
+    // Uses the bullet image when it exists, otherwise yellow 5x15 rectangles.
+    // The size comes from the image file so headless runs collide identically;
+    // sourceScale undoes any downscaling done by the asset pipeline.
+    void setTexture(const sf::Texture* tex, sf::IntRect rect, sf::Vector2f sourceScale = sf::Vector2f(1.f, 1.f)) {
+        if (tex && rect.width > 0) {
+            texture = tex;
+            textureRect = rect;
+            bulletSize = sf::Vector2f(rect.width * sourceScale.x * spriteScale, rect.height * sourceScale.y * spriteScale);
+        }
+        else {
+            texture = nullptr;
+            bulletSize = sf::Vector2f(5.f, 15.f);
+        }
+    }
+
+    void spawn(float x, float y, sf::Vector2f dir) {
+        posX.push_back(x);
+        posY.push_back(y);
+        prevX.push_back(x);
+        prevY.push_back(y);
+        dirX.push_back(dir.x);
+        dirY.push_back(dir.y);
+        alive.push_back(1);
+    }
+
+    void integrate(float dt) {
+        prevX = posX;
+        prevY = posY;
+
+        const size_t n = posX.size();
+        const float step = speed * dt;
+        float* px = posX.data();
+        float* py = posY.data();
+        const float* dx = dirX.data();
+        const float* dy = dirY.data();
+        for (size_t i = 0; i < n; ++i) {
+            px[i] += dx[i] * step;
+            py[i] += dy[i] * step;
+        }
+    }
+
+    // Marks bullets that left the top or sides of the screen, then compacts.
+    void cullOffscreen() {
+        const size_t n = posX.size();
+        for (size_t i = 0; i < n; ++i) {
+            if (posY[i] < -10 || posX[i] < -10 || posX[i] > 810)
+                alive[i] = 0;
+        }
+        compact();
+    }
+
+    void kill(size_t i) { alive[i] = 0; }
+
+    // Stable single-pass removal of dead bullets, keeps firing order.
+    void compact() {
+        size_t out = 0;
+        const size_t n = posX.size();
+        for (size_t i = 0; i < n; ++i) {
+            if (!alive[i])
+                continue;
+            posX[out] = posX[i];
+            posY[out] = posY[i];
+            prevX[out] = prevX[i];
+            prevY[out] = prevY[i];
+            dirX[out] = dirX[i];
+            dirY[out] = dirY[i];
+            alive[out] = 1;
+            ++out;
+        }
+        posX.resize(out);
+        posY.resize(out);
+        prevX.resize(out);
+        prevY.resize(out);
+        dirX.resize(out);
+        dirY.resize(out);
+        alive.resize(out);
+    }
+
+    void clear() {
+        posX.clear();
+        posY.clear();
+        prevX.clear();
+        prevY.clear();
+        dirX.clear();
+        dirY.clear();
+        alive.clear();
+    }
+
+    size_t size() const { return posX.size(); }
+    bool empty() const { return posX.empty(); }
+
+    // Same numbers a scaled sprite's getGlobalBounds() gives: the size goes
+    // through the far corner, so edge hits round exactly as they did before.
+    sf::FloatRect getBounds(size_t i) const {
+        const float x = posX[i], y = posY[i];
+        return sf::FloatRect(x, y, (bulletSize.x + x) - x, (bulletSize.y + y) - y);
+    }
+
+    void fillBoxes(BoxSoA& boxes) const {
+        boxes.clear();
+        const size_t n = posX.size();
+        for (size_t i = 0; i < n; ++i)
+            boxes.push(getBounds(i));
+    }
+
+    sf::Vector2f getPosition(size_t i) const {
+        return sf::Vector2f(posX[i], posY[i]);
+    }
+
+    // Writes one quad per bullet at its interpolated position straight into
+    // the batch's vertex storage.
+    void draw(SpriteBatch& batch, float alpha = 1.f) {
+        const size_t n = posX.size();
+        if (n == 0)
+            return;
+        sf::Vertex* quads = batch.allocate(texture, n);
+
+        float u0 = 0.f, v0 = 0.f, u1 = 0.f, v1 = 0.f;
+        if (texture) {
+            u0 = static_cast<float>(textureRect.left);
+            v0 = static_cast<float>(textureRect.top);
+            u1 = u0 + textureRect.width;
+            v1 = v0 + textureRect.height;
+        }
+        sf::Color color = texture ? sf::Color::White : sf::Color::Yellow;
+
+        for (size_t i = 0; i < n; ++i) {
+            sf::Vertex* q = quads + i * 4;
+            float x = prevX[i] + (posX[i] - prevX[i]) * alpha;
+            float y = prevY[i] + (posY[i] - prevY[i]) * alpha;
+
+            q[0].position = sf::Vector2f(x, y);
+            q[1].position = sf::Vector2f(x + bulletSize.x, y);
+            q[2].position = sf::Vector2f(x + bulletSize.x, y + bulletSize.y);
+            q[3].position = sf::Vector2f(x, y + bulletSize.y);
+
+            q[0].texCoords = sf::Vector2f(u0, v0);
+            q[1].texCoords = sf::Vector2f(u1, v0);
+            q[2].texCoords = sf::Vector2f(u1, v1);
+            q[3].texCoords = sf::Vector2f(u0, v1);
+
+            for (int k = 0; k < 4; ++k)
+                q[k].color = color;
+        }
+    }
+};
+
+//---------------------------------- Bomb (Invader Drop) ----------------------------------
+class Bomb {
+private:
+    sf::Sprite sprite;
+    BoundsCache bounds;
+    std::shared_ptr<sf::Texture> texture;
+    sf::Vector2f previousPosition;
+    float speed;    // pixels per second
+
+public:
+    Bomb(float x, float y, float spd = 100.f)
+        : previousPosition(x, y), speed(spd)
+    {
+        static const std::string path = "assets/bomb.png";
+        texture = ResourceCache::instance().bindSprite(sprite, path);
+
+        ResourceCache::instance().scaleSprite(sprite, path, 0.03f, 0.03f);  // adjust size as needed
+        sprite.setPosition(x, y);
+    }
+
+    void move(float dt) {
+        previousPosition = sprite.getPosition();
+        sprite.move(0.f, speed * dt);
+        bounds.markMoved();
+    }
+
+    void draw(SpriteBatch& batch, float alpha = 1.f) {
+        batch.add(sprite, interpolationOffset(previousPosition, sprite.getPosition(), alpha));
+    }
+
+    const sf::FloatRect& getBounds() const {
+        return bounds.get(sprite);
+    }
+
+    void setPosition(float x, float y) {
+        sprite.setPosition(x, y);
+        bounds.markMoved();
+    }
+
+    sf::Vector2f getPosition() const {
+        return sprite.getPosition();
+    }
+};
+
+
+
+//---------------------------------- Spaceship ----------------------------------
+class Spaceship {
+public:
+    sf::Sprite sprite;
+    std::shared_ptr<sf::Texture> texture;
+    sf::Vector2f previousPosition;
+    float speed;    // pixels per second
+    int lives;
+    bool isPoweredUp = false;
+    bool isOnFire = false;
+
+private:
+    enum Effect { EffectPowerUp, EffectFire };
+    BoundsCache bounds;
+    TimerWheel* timers = nullptr;
+    TimerHandle powerHandle, fireHandle;
+
+    static void onEffectExpired(void* owner, int effect) {
+        Spaceship* ship = static_cast<Spaceship*>(owner);
+        if (effect == EffectPowerUp) ship->isPoweredUp = false;
+        else ship->isOnFire = false;
+    }
+
+public:
+
+    Spaceship() {
+        texture = ResourceCache::instance().bindSprite(sprite, "assets/sp.png");
+        ResourceCache::instance().scaleSprite(sprite, "assets/sp.png", 0.10f, 0.10f); // Makes it smaller
+        sprite.setPosition(370.f, 500.f);
+        previousPosition = sprite.getPosition();
+        speed = 360.f;
+        lives = 3;
+    }
+
+    void move(const TickInput& input, float dt) {
+        previousPosition = sprite.getPosition();
+
+        sf::Vector2f movement(0.f, 0.f);
+        float step = speed * dt;
+        if (input.left) movement.x -= step;
+        if (input.right) movement.x += step;
+        if (input.up) movement.y -= step;
+        if (input.down) movement.y += step;
+
+        sprite.move(movement);
+
+        // Wrap-around
+        sf::Vector2f pos = sprite.getPosition();
+        if (pos.x < -40) sprite.setPosition(800, pos.y);
+        if (pos.x > 800) sprite.setPosition(-40, pos.y);
+        if (pos.y < -40) sprite.setPosition(pos.x, 600);
+        if (pos.y > 600) sprite.setPosition(pos.x, -40);
+        bounds.markMoved();
+    }
+
+    void attachTimers(TimerWheel& wheel) { timers = &wheel; }
+
+    void activatePowerUp() {
+        isPoweredUp = true;
+        timers->cancel(powerHandle);
+        powerHandle = timers->scheduleIn(5.f, &Spaceship::onEffectExpired, this, EffectPowerUp);
+    }
+
+    void activateFireMode() {
+        isOnFire = true;
+        timers->cancel(fireHandle);
+        fireHandle = timers->scheduleIn(5.f, &Spaceship::onEffectExpired, this, EffectFire);
+    }
+
+    void clearEffects() {
+        isPoweredUp = false;
+        isOnFire = false;
+        timers->cancel(powerHandle);
+        timers->cancel(fireHandle);
+    }
+
+    void respawn() {
+        sprite.setPosition(370.f, 500.f);
+        bounds.markMoved();
+        previousPosition = sprite.getPosition();
+        lives = 3;
+        clearEffects();
+    }
+
+    sf::Vector2f getPosition() const {
+        return sprite.getPosition();
+    }
+
+    const sf::FloatRect& getBounds() const {
+        return bounds.get(sprite);
+    }
+
+    void draw(SpriteBatch& batch, float alpha = 1.f) {
+        batch.add(sprite, interpolationOffset(previousPosition, sprite.getPosition(), alpha));
+    }
+};
+
+
+//---------------------------------- AddOn ----------------------------------
+class AddOn {
+protected:
+    sf::Sprite sprite;
+    BoundsCache bounds;
+    std::shared_ptr<sf::Texture> texture;
+    sf::Vector2f previousPosition;
+    float speed = 120.f;    // pixels per second
+
+    void spawnAt(float x) {
+        sprite.setPosition(sf::Vector2f(x, 0.f));
+        bounds.markMoved();
+        previousPosition = sprite.getPosition();
+    }
+
+public:
+    virtual ~AddOn() {}
+
+    virtual void fall(float dt) {
+        previousPosition = sprite.getPosition();
+        sprite.move(0, speed * dt);
+        bounds.markMoved();
+    }
+
+    const sf::FloatRect& getBounds() const {
+        return bounds.get(sprite);
+    }
+
+    virtual void draw(SpriteBatch& batch, float alpha = 1.f) {
+        batch.add(sprite, interpolationOffset(previousPosition, sprite.getPosition(), alpha));
+    }
+
+    // Updated to support bullet parameter
+    virtual void applyEffect(Spaceship& player, int& score, BulletSystem& bullets) = 0;
+
+    virtual bool isDangerous() const { return false; }
+
+    virtual bool isOutOfScreen() const {
+        return sprite.getPosition().y > 600;
+    }
+};
+
+class PowerUpAddOn : public AddOn {
+public:
+    PowerUpAddOn(float x) {
+        static const std::string path = "assets/powerUp.png";
+        texture = ResourceCache::instance().bindSprite(sprite, path);
+        ResourceCache::instance().scaleSprite(sprite, path, 0.05f, 0.05f);
+        spawnAt(x);
+    }
+        void applyEffect(Spaceship& player, int& score, BulletSystem&) override
+        {
+            player.activatePowerUp();
+            // No bullets here any more!
+        }
+    };
+
+class ExtraLifeAddOn : public AddOn {
+public:
+    ExtraLifeAddOn(float x) {
+        static const std::string path = "assets/extra_life.png";
+        texture = ResourceCache::instance().bindSprite(sprite, path);
+        ResourceCache::instance().scaleSprite(sprite, path, 0.04f, 0.04f);
+        spawnAt(x);
+    }
+
+    void applyEffect(Spaceship& player, int& score, BulletSystem&) override {
+        player.lives++;
+    }
+};
+
+class DangerAddOn : public AddOn {
+public:
+    DangerAddOn(float x) {
+        static const std::string path = "assets/danger_sign.png";
+        texture = ResourceCache::instance().bindSprite(sprite, path);
+        ResourceCache::instance().scaleSprite(sprite, path, 0.008f, 0.008f);
+        spawnAt(x);
+    }
+
+    void applyEffect(Spaceship& player, int& score, BulletSystem&) override {
+        player.lives--;
+    }
+
+    bool isDangerous() const override { return true; }
+};
+
+// Room for the largest add-on, so one pool holds all kinds.
+constexpr size_t AddOnSlotSize = std::max({ sizeof(PowerUpAddOn), sizeof(ExtraLifeAddOn), sizeof(DangerAddOn) });
+typedef ObjectPool<AddOn, AddOnSlotSize> AddOnPool;
+
+//-----------------------------levelManager-----------------------------
+class LevelManager {
+private:
+    int currentLevel = 1;
+    int currentWave = 1;
+
+    static void spawn(InvaderArena& arena, std::vector<Invader*>& invaders,
+        InvaderKind kind, sf::Vector2f startPos, sf::Vector2f targetPos) {
+        invaders.push_back(arena.create(kind, startPos, targetPos));
+    }
+
+public:
+    bool waveJustChanged = false;
+    int getLevel() const { return currentLevel; }
+    int getWave() const { return currentWave; }
+
+    void advanceWave() {
+        int maxWaves = getWavesForCurrentLevel();
+
+        currentWave++;
+        if (currentWave > maxWaves) {
+            currentWave = 1;
+            currentLevel++;
+        }
+    }
+
+    int getWavesForCurrentLevel() const {
+        if (currentLevel == 1 || currentLevel == 2) return 3;
+        if (currentLevel == 3) return 3; // we removed old wave 3
+        return 0;
+    }
+    //rectangle
+    void createWave1(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 4;
+        const int cols = 10;
+        const float spacingX = 60.f;
+        const float spacingY = 60.f;
+
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                if (row == 0 || row == rows - 1 || col == 0 || col == cols - 1) {
+                    sf::Vector2f startPos(-50.f, 50.f + row * spacingY);
+                    sf::Vector2f targetPos(100.f + col * spacingX, 50.f + row * spacingY);
+                    spawn(arena, invaders, InvaderAlpha, startPos, targetPos);
+                }
+            }
+        }
+    }
+    //triangle
+    void createWave2(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 5;
+        const float spacingX = 60.f;
+        const float spacingY = 60.f;
+        const float centerX = 400.f;
+
+        for (int row = 0; row < rows; ++row) {
+            int numInRow = 2 * row + 1;
+            float startX = centerX - (numInRow / 2.f) * spacingX;
+
+            for (int i = 0; i < numInRow; ++i) {
+                if (i == 0 || i == numInRow - 1 || row == rows - 1) {
+                    sf::Vector2f startPos(850.f, 50.f + row * spacingY);
+                    sf::Vector2f targetPos(startX + i * spacingX, 50.f + row * spacingY);
+                    spawn(arena, invaders, InvaderAlpha, startPos, targetPos);
+                }
+            }
+        }
+    }
+    void createLevel1Wave3_Mirror(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 5;
+        const float spacingY = 60.f;
+
+        for (int i = 0; i < rows; ++i) {
+            float y = 80.f + i * spacingY;
+
+            // Left side enemy ? moves right to center
+            sf::Vector2f startLeft(-50.f, y);
+            sf::Vector2f targetLeft(300.f, y);
+            spawn(arena, invaders, InvaderAlpha, startLeft, targetLeft);
+
+            // Right side enemy ? moves left to center
+            sf::Vector2f startRight(850.f, y);
+            sf::Vector2f targetRight(500.f, y);
+            spawn(arena, invaders, InvaderAlpha, startRight, targetRight);
+        }
+    }
+
+    //circle
+    void createLevel2Wave1(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int enemyCount = 18;
+        const float radius = 150.f;
+        const float centerX = 400.f;
+        const float centerY = 200.f;
+
+        for (int i = 0; i < enemyCount; ++i) {
+            float angle = i * (2 * 3.14159265f / enemyCount);
+            float targetX = centerX + radius * std::cos(angle);
+            float targetY = centerY + radius * std::sin(angle);
+
+            sf::Vector2f startPos(-50.f, targetY);
+            sf::Vector2f targetPos(targetX, targetY);
+
+            if (i % 2 == 0)
+                spawn(arena, invaders, InvaderAlpha, startPos, targetPos);
+            else
+                spawn(arena, invaders, InvaderBeta, startPos, targetPos);
+        }
+    }
+    //diamond
+    void createLevel2Wave2(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 7;
+        const int maxCols = 7;
+        const float spacingX = 55.f;
+        const float spacingY = 55.f;
+        const float centerX = 400.f;
+
+        for (int row = 0; row < rows; ++row) {
+            int half = rows / 2;
+            int numInRow = row <= half ? row * 2 + 1 : (rows - row - 1) * 2 + 1;
+
+            float startX = centerX - (numInRow / 2.f) * spacingX;
+            float y = 60.f + row * spacingY;
+
+            for (int col = 0; col < numInRow; ++col) {
+
+                if (col != 0 && col != numInRow - 1)
+                    continue;
+
+                float x = startX + col * spacingX;
+
+
+                if ((row + col) % 2 == 0)
+                    spawn(arena, invaders, InvaderAlpha, sf::Vector2f(850.f, y), sf::Vector2f(x, y));
+                else
+                    spawn(arena, invaders, InvaderBeta, sf::Vector2f(850.f, y), sf::Vector2f(x, y));
+            }
+        }
+    }
+    void createLevel2Wave3_SlideInColumns(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int columns = 5;
+        const int enemiesPerColumn = 4;
+        const float spacingX = 100.f;
+        const float spacingY = 60.f;
+
+        for (int col = 0; col < columns; ++col) {
+            float x = 100.f + col * spacingX;
+
+            for (int row = 0; row < enemiesPerColumn; ++row) {
+                float y = 60.f + row * spacingY;
+
+                if (col % 2 == 0) {
+                    // Left slide-in
+                    spawn(arena, invaders, InvaderBeta, sf::Vector2f(-50.f, y), sf::Vector2f(x, y));
+                }
+                else {
+                    // Right slide-in
+                    spawn(arena, invaders, InvaderBeta, sf::Vector2f(850.f, y), sf::Vector2f(x, y));
+                }
+            }
+        }
+    }
+
+    //filled rectangle
+    void createLevel3Wave1(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 3;
+        const int cols = 10;
+        const float spacingX = 60.f;
+        const float spacingY = 60.f;
+
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                sf::Vector2f start(-50.f, 50.f + row * spacingY);
+                sf::Vector2f target(100.f + col * spacingX, 50.f + row * spacingY);
+
+                int choice = (row + col) % 3;
+                if (choice == 0) spawn(arena, invaders, InvaderAlpha, start, target);
+                else if (choice == 1) spawn(arena, invaders, InvaderBeta, start, target);
+                else spawn(arena, invaders, InvaderGamma, start, target);
+            }
+        }
+    }
+    //filled triangle
+    void createLevel3Wave2(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 4;
+        const float spacingX = 55.f;
+        const float spacingY = 55.f;
+        const float centerX = 400.f;
+
+        for (int row = 0; row < rows; ++row) {
+            int numInRow = 2 * row + 1;
+            float startX = centerX - (numInRow / 2.f) * spacingX;
+
+            for (int col = 0; col < numInRow; ++col) {
+                sf::Vector2f start(850.f, 60.f + row * spacingY);
+                sf::Vector2f target(startX + col * spacingX, 60.f + row * spacingY);
+
+                int choice = (row + col) % 3;
+                if (choice == 0) spawn(arena, invaders, InvaderAlpha, start, target);
+                else if (choice == 1) spawn(arena, invaders, InvaderBeta, start, target);
+                else spawn(arena, invaders, InvaderGamma, start, target);
+            }
+        }
+    }
+    //filled circle-> require modification
+    void createLevel3Wave3(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const float centerX = 400.f;
+        const float centerY = 200.f;
+        const float maxRadius = 150.f;
+        const int rings = 3; // Number of concentric rings
+        const int baseEnemies = 6; // Enemies in innermost ring
+
+        for (int r = 1; r <= rings; ++r) {
+            float radius = (r / static_cast<float>(rings)) * maxRadius;
+            int enemiesInRing = baseEnemies + r * 2; // Increase enemies for outer rings
+
+            for (int i = 0; i < enemiesInRing; ++i) {
+                float angle = i * (2 * 3.14159265f / enemiesInRing);
+                float x = centerX + radius * std::cos(angle);
+                float y = centerY + radius * std::sin(angle);
+
+                sf::Vector2f startPos(-50.f, y); // Enter from left
+                sf::Vector2f targetPos(x, y);
+
+                // Alternate types for visual variety
+                if ((i + r) % 3 == 0)
+                    spawn(arena, invaders, InvaderAlpha, startPos, targetPos);
+                else if ((i + r) % 3 == 1)
+                    spawn(arena, invaders, InvaderBeta, startPos, targetPos);
+                else
+                    spawn(arena, invaders, InvaderGamma, startPos, targetPos);
+            }
+        }
+    }
+
+
+    //filled diamond
+    void createLevel3Wave4(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        const int rows = 7;
+        const float spacingX = 55.f;
+        const float spacingY = 55.f;
+        const float centerX = 400.f;
+
+        for (int row = 0; row < rows; ++row) {
+            int half = rows / 2;
+            int numInRow = row <= half ? row * 2 + 1 : (rows - row - 1) * 2 + 1;
+
+            float startX = centerX - (numInRow / 2.f) * spacingX;
+            float y = 60.f + row * spacingY;
+
+            for (int i = 0; i < numInRow; ++i) {
+                sf::Vector2f start(850.f, y);
+                sf::Vector2f target(startX + i * spacingX, y);
+
+                int choice = (row + i) % 3;
+                if (choice == 0) spawn(arena, invaders, InvaderAlpha, start, target);
+                else if (choice == 1) spawn(arena, invaders, InvaderBeta, start, target);
+                else spawn(arena, invaders, InvaderGamma, start, target);
+            }
+        }
+    }
+
+    void nextWaveOrLevel(InvaderArena& arena, std::vector<Invader*>& invaders) {
+        if (currentLevel == 1 && currentWave == 1) {
+            advanceWave();
+            createWave2(arena, invaders);  
+        }
+        else if (currentLevel == 1 && currentWave == 2) {
+            advanceWave();
+            createLevel1Wave3_Mirror(arena, invaders);  
+        }
+        else if (currentLevel == 2 && currentWave == 1) {
+            advanceWave();
+            createLevel2Wave2(arena, invaders);  
+        }
+        else if (currentLevel == 2 && currentWave == 2) {
+            advanceWave();
+            createLevel2Wave3_SlideInColumns(arena, invaders);  
+        }
+        else if (currentLevel == 3 && currentWave == 1) {
+            advanceWave();
+            createLevel3Wave2(arena, invaders); 
+        }
+        else if (currentLevel == 3 && currentWave == 2) {
+            advanceWave();
+            createLevel3Wave4(arena, invaders);  
+        }
+        else {
+            advanceWave();
+            if (currentLevel == 2)
+                createLevel2Wave1(arena, invaders);
+            else if (currentLevel == 3)
+                createLevel3Wave1(arena, invaders);
+        }
+    }
+};
+
+
+//---------------------------------- HUD ----------------------------------
+// Text bound to an int value; the string is rebuilt only when the value changes.
+class HudCounter {
+private:
+    sf::Text text;
+    std::string prefix;
+    int value = 0;
+    bool valid = false;
+
+public:
+    void setup(const sf::Font& font, unsigned size, sf::Color color, sf::Vector2f pos, const std::string& label) {
+        text.setFont(font);
+        text.setCharacterSize(size);
+        text.setFillColor(color);
+        text.setPosition(pos);
+        prefix = label;
+        valid = false;
+    }
+
+    void set(int v) {
+        if (valid && v == value)
+            return;
+        value = v;
+        valid = true;
+        ScratchString s = scratchString(prefix.c_str());
+        text.setString(appendNumber(s, v).c_str());
+    }
+
+    void draw(sf::RenderWindow& window) const {
+        window.draw(text);
+    }
+};
+
+// Retained in-game overlay. Every widget owns its sf::Text and is only rebuilt when
+// its bound value (score, lives, level/wave, leaderboard version) changes; the fixed
+// banners are built once.
+class Hud {
+private:
+    std::shared_ptr<sf::Font> font;
+    HudCounter scoreText, livesText;
+
+    sf::Text levelText;
+    int shownLevel = -1;
+    int shownWave = -1;
+
+    std::vector<sf::Text> badgeTexts;
+    unsigned leaderboardVersion = 0;
+    bool leaderboardValid = false;
+
+    sf::Text startingText;
+    sf::Text warningText;
+
+    sf::Text statsText;
+    RenderStats shownStats;
+    bool statsValid = false;
+
+public:
+    Hud() {
+        font = ResourceCache::instance().getFont("assets/Orbitron-Regular.ttf");
+
+        scoreText.setup(*font, 18, sf::Color::White, sf::Vector2f(10.f, 10.f), "Score: ");
+        livesText.setup(*font, 18, sf::Color::White, sf::Vector2f(680.f, 10.f), "Lives: ");
+
+        levelText.setFont(*font);
+        levelText.setCharacterSize(16);
+        levelText.setFillColor(sf::Color::Cyan);
+        levelText.setPosition(320, 10);
+
+        startingText.setFont(*font);
+        startingText.setCharacterSize(28);
+        startingText.setFillColor(sf::Color::Yellow);
+        startingText.setString("GAME STARTING...");
+        startingText.setPosition(250, 250);
+
+        warningText.setFont(*font);
+        warningText.setCharacterSize(30);
+        warningText.setFillColor(sf::Color::Red);
+        warningText.setOutlineColor(sf::Color::Black);
+        warningText.setOutlineThickness(2);
+        warningText.setString("MONSTER APPROACHING");
+        warningText.setPosition(200, 210);
+
+        statsText.setFont(*font);
+        statsText.setCharacterSize(14);
+        statsText.setFillColor(sf::Color::Green);
+        statsText.setPosition(10.f, 575.f);
+    }
+
+    void setScore(int score) { scoreText.set(score); }
+    void setLives(int lives) { livesText.set(lives); }
+
+    void setLevel(int level, int wave) {
+        if (level == shownLevel && wave == shownWave)
+            return;
+        shownLevel = level;
+        shownWave = wave;
+        ScratchString s = scratchString("Level ");
+        appendNumber(s, level).append(" - Wave ");
+        levelText.setString(appendNumber(s, wave).c_str());
+    }
+
+    void setLeaderboard(const HighScoreManager& manager) {
+        if (leaderboardValid && manager.getVersion() == leaderboardVersion)
+            return;
+        leaderboardValid = true;
+        leaderboardVersion = manager.getVersion();
+
+        const auto& topScores = manager.getScores();
+        badgeTexts.clear();
+        for (size_t i = 0; i < 3 && i < topScores.size(); ++i) {
+            sf::Text badgeText;
+            badgeText.setFont(*font);
+            badgeText.setCharacterSize(16);
+            badgeText.setFillColor(sf::Color::White);
+            ScratchString s = scratchString(topScores[i].getName().c_str());
+            s.append(": ").append(topScores[i].getBadge());
+            badgeText.setString(s.c_str());
+            badgeText.setPosition(10.f, 40.f + i * 20.f);
+            badgeTexts.push_back(badgeText);
+        }
+    }
+
+    void setRenderStats(const RenderStats& stats) {
+        if (statsValid && stats.drawCalls == shownStats.drawCalls && stats.vertices == shownStats.vertices)
+            return;
+        statsValid = true;
+        shownStats = stats;
+        ScratchString s = scratchString("draw calls: ");
+        appendNumber(s, stats.drawCalls).append("  vertices: ");
+        statsText.setString(appendNumber(s, stats.vertices).c_str());
+    }
+
+    void drawLeaderboard(sf::RenderWindow& window) const {
+        for (const auto& t : badgeTexts)
+            window.draw(t);
+    }
+
+    void drawCounters(sf::RenderWindow& window) const {
+        scoreText.draw(window);
+        livesText.draw(window);
+    }
+
+    void drawLevel(sf::RenderWindow& window) const { window.draw(levelText); }
+    void drawStarting(sf::RenderWindow& window) const { window.draw(startingText); }
+    void drawMonsterWarning(sf::RenderWindow& window) const { window.draw(warningText); }
+    void drawRenderStats(sf::RenderWindow& window) const { window.draw(statsText); }
+};
+
+//---------------------------------- SpatialHashGrid ----------------------------------
+// Uniform grid over the 800x600 playfield used as the bullet-vs-invader broadphase
+// once there are too many pairs for the batch kernel's linear scan to keep up.
+// Items are stored per cell in ascending index order, so a query returns the same
+// "first invader in the list" hit that a linear scan would.
+class SpatialHashGrid {
+private:
+    float cellSize;
+    int cols;
+    int rows;
+
+    std::vector<int> cellStart;     // cols*rows + 1 offsets into cellItems
+    std::vector<int> cellItems;     // item indices grouped by cell
+    std::vector<int> cellFill;
+    std::vector<sf::FloatRect> boxes;
+
+    // Anything outside the playfield lands in the border cells, so off-screen
+    // invaders (still sliding in, or parked at -100,-100) are never missed.
+    int cellX(float x) const {
+        int c = static_cast<int>(std::floor(x / cellSize));
+        return std::max(0, std::min(cols - 1, c));
+    }
+
+    int cellY(float y) const {
+        int c = static_cast<int>(std::floor(y / cellSize));
+        return std::max(0, std::min(rows - 1, c));
+    }
+
+public:
+    SpatialHashGrid(float width = 800.f, float height = 600.f, float cell = 64.f)
+        : cellSize(cell),
+        cols(static_cast<int>(std::ceil(width / cell))),
+        rows(static_cast<int>(std::ceil(height / cell)))
+    {
+        cellStart.assign(cols * rows + 1, 0);
+        cellFill.assign(cols * rows, 0);
+    }
+
+    // Rebuilds the grid from scratch with a counting sort; O(items + cells).
+    void rebuild(const std::vector<sf::FloatRect>& bounds) {
+        boxes = bounds;
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+
+        for (const auto& b : boxes) {
+            int x0 = cellX(b.left), x1 = cellX(b.left + b.width);
+            int y0 = cellY(b.top), y1 = cellY(b.top + b.height);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    cellStart[y * cols + x + 1]++;
+        }
+        for (size_t c = 1; c < cellStart.size(); ++c)
+            cellStart[c] += cellStart[c - 1];
+
+        cellItems.resize(cellStart.back());
+        std::copy(cellStart.begin(), cellStart.end() - 1, cellFill.begin());
+
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            const auto& b = boxes[i];
+            int x0 = cellX(b.left), x1 = cellX(b.left + b.width);
+            int y0 = cellY(b.top), y1 = cellY(b.top + b.height);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    cellItems[cellFill[y * cols + x]++] = i;
+        }
+    }
+
+    // Lowest item index whose box intersects `box`, or -1 if none does.
+    int findFirstHit(const sf::FloatRect& box) const {
+        int best = -1;
+        int x0 = cellX(box.left), x1 = cellX(box.left + box.width);
+        int y0 = cellY(box.top), y1 = cellY(box.top + box.height);
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int cell = y * cols + x;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    int idx = cellItems[k];
+                    if (best != -1 && idx >= best)
+                        break;  // cell is sorted, nothing lower left here
+                    if (boxes[idx].intersects(box))
+                        best = idx;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Item i stops reporting hits until the next rebuild.
+    void disable(size_t i) { boxes[i] = sf::FloatRect(0.f, 0.f, 0.f, 0.f); }
+
+    size_t size() const { return boxes.size(); }
+};
+
+//---------------------------------- BombScheduler ----------------------------------
+// Decides which invaders drop bombs. An invader's cooldown is a timer on the
+// wheel; when it expires the invader joins the ready list, so a volley only
+// looks at invaders that can actually shoot, never at the whole formation.
+class BombScheduler {
+private:
+    TimerWheel& timers;
+    std::vector<Invader*> ready;
+    Pcg32& rng;
+
+    static void onCooled(void* owner, int) {
+        Invader* invader = static_cast<Invader*>(owner);
+        BombScheduler* self = invader->bombSlot.scheduler;
+        invader->bombSlot.readyIndex = static_cast<int>(self->ready.size());
+        self->ready.push_back(invader);
+    }
+
+    void unready(Invader* invader) {
+        int idx = invader->bombSlot.readyIndex;
+        if (idx < 0)
+            return;
+        ready[idx] = ready.back();
+        ready[idx]->bombSlot.readyIndex = idx;
+        ready.pop_back();
+        invader->bombSlot.readyIndex = -1;
+    }
+
+    void arm(Invader* invader) {
+        invader->bombSlot.cooldown = timers.scheduleIn(invader->getBombCooldown(), &BombScheduler::onCooled, invader);
+    }
+
+public:
+    BombScheduler(TimerWheel& wheel, Pcg32& stream)
+        : timers(wheel), rng(stream)
+    {
+    }
+
+    BombScheduler(const BombScheduler&) = delete;
+    BombScheduler& operator=(const BombScheduler&) = delete;
+
+    // Starts the invader's first cooldown. Invaders must be withdrawn before
+    // they are deleted.
+    void enroll(Invader* invader) {
+        invader->bombSlot.scheduler = this;
+        arm(invader);
+    }
+
+    void withdraw(Invader* invader) {
+        if (invader->bombSlot.scheduler != this)
+            return;
+        timers.cancel(invader->bombSlot.cooldown);
+        unready(invader);
+        invader->bombSlot.scheduler = nullptr;
+    }
+
+    // Picks up to maxDrops of the ready, aligned invaders uniformly at random
+    // (reservoir sampling over the scheduler's random stream), calls drop() for each and restarts their cooldowns.
+    // Ready invaders that are still flying in stay queued for the next volley.
+    template <typename DropFn>
+    void dispatch(int maxDrops, DropFn drop) {
+        Invader* chosen[8];
+        maxDrops = std::min(maxDrops, 8);
+        int seen = 0;
+        for (Invader* invader : ready) {
+            if (!invader->isAligned())
+                continue;
+            if (seen < maxDrops) {
+                chosen[seen] = invader;
+            }
+            else {
+                int j = static_cast<int>(rng.below(static_cast<uint32_t>(seen + 1)));
+                if (j < maxDrops)
+                    chosen[j] = invader;
+            }
+            seen++;
+        }
+
+        int count = std::min(seen, maxDrops);
+        for (int i = 0; i < count; ++i) {
+            unready(chosen[i]);
+            drop(chosen[i]);
+            arm(chosen[i]);
+        }
+    }
+
+    size_t readyCount() const { return ready.size(); }
+};
+
+//---------------------------------- Simulation ----------------------------------
+// Events the frontend reacts to; they accumulate until takeEvents() is called.
+enum SimEvent : unsigned {
+    SimEventNone = 0,
+    SimEventWaveStarted = 1 << 0,
+    SimEventMonsterDestroyed = 1 << 1,
+    SimEventMonsterEscaped = 1 << 2,
+    SimEventGameOver = 1 << 3
+};
+
+// All gameplay state and rules. It steps on an explicit TickInput and dt and has
+// no window, keyboard or wall-clock dependency, so it can run headless.
+class Simulation
+{
+public:
+    static constexpr int TickRate = SimTickRate;
+    static constexpr float TickSeconds = SimTickSeconds;
+
+private:
+    // Simulation-wide countdowns. Each sets its due flag when it expires; the
+    // flag stays set until step() consumes it and restarts the timer.
+    enum SimTimer {
+        TimerAddOnSpawn,
+        TimerBombVolley,
+        TimerMonsterTrigger,
+        TimerMonsterWarning,
+        TimerMonsterLifetime,
+        TimerCount
+    };
+
+    // Declared first so it outlives every entity holding a handle into it.
+    TimerWheel timers;
+    RandomStreams rng;
+    BombScheduler bombScheduler;
+    TimerHandle timerHandles[TimerCount];
+    bool timerDue[TimerCount] = {};
+
+    Spaceship player;
+    BulletSystem bullets;
+    std::shared_ptr<sf::Texture> bulletTexture;
+    InvaderArena invaderArena;      // backs every invader in `invaders`
+    vector<Invader*> invaders;
+
+    // Sized well above what a game ever holds at once; a full pool just skips
+    // the spawn. Entities come and go without touching the heap.
+    static const size_t MaxAddOns = 16;
+    static const size_t MaxBombs = 64;
+    static const size_t MaxExplosions = 64;
+    AddOnPool addons{ MaxAddOns };
+    ObjectPool<Bomb> bombs{ MaxBombs };
+    ObjectPool<Explosion> explosions{ MaxExplosions };
+    BoxSoA boxes;                   // scratch for the collision passes
+    HitMask hits;
+    SpatialHashGrid invaderGrid;
+    std::vector<sf::FloatRect> invaderBounds;
+
+    // Above this many bullet x invader pairs the grid's bucketing beats testing
+    // every pair 4 or 8 at a time (crossover measured with --bench-broadphase
+    // between ~4k and ~8k pairs depending on the bullet/invader mix).
+    static const size_t GridPairThreshold = 6144;
+
+    LevelManager levelManager;
+    int score = 0;
+    bool gameOver = false;
+    unsigned events = SimEventNone;
+
+    Monster* monster = nullptr;
+    bool monsterActive = false;
+    float monsterDuration = 25.f;
+    bool monsterScoreGiven = false;
+    float monsterTriggerTime = 10.f; // Random between 10-20s, rolled in reset()
+    bool showMonsterWarning = false;
+
+    float globalBombInterval = 1.5f; // Try to drop bombs every 1.5 seconds
+
+    bool monsterHasAppeared = false;
+    uint64_t startTick = 0;
+
+    static void onTimer(void* owner, int timer) {
+        static_cast<Simulation*>(owner)->timerDue[timer] = true;
+    }
+
+    void restartTimer(SimTimer timer, float seconds) {
+        timerDue[timer] = false;
+        timers.cancel(timerHandles[timer]);
+        timerHandles[timer] = timers.scheduleIn(seconds, &Simulation::onTimer, this, timer);
+    }
+
+    void stopTimer(SimTimer timer) {
+        timerDue[timer] = false;
+        timers.cancel(timerHandles[timer]);
+    }
+
+    void attachInvaders() {
+        for (auto* e : invaders) {
+            e->attach(timers, rng[RngAI]);
+            bombScheduler.enroll(e);
+        }
+    }
+
+    void destroyInvader(Invader* e) {
+        bombScheduler.withdraw(e);
+        invaderArena.destroy(e);
+    }
+
+    // Stable single-pass removal; list order decides which invader a bullet
+    // hits first, so it has to survive.
+    void removeDeadInvaders() {
+        size_t out = 0;
+        for (auto* e : invaders) {
+            if (e->isDead())
+                destroyInvader(e);
+            else
+                invaders[out++] = e;
+        }
+        invaders.resize(out);
+    }
+
+    void destroyInvaders() {
+        for (auto* e : invaders) destroyInvader(e);
+        invaders.clear();
+        invaderArena.rewind();
+    }
+
+    uint64_t explosionExpiry() const {
+        return timers.now() + TimerWheel::ticksFor(Explosion::Duration);
+    }
+
+    void endGame() {
+        gameOver = true;
+        events |= SimEventGameOver;
+    }
+
+public:
+    explicit Simulation(unsigned seed = 1)
+        : bombScheduler(timers, rng[RngBombs])
+    {
+        const std::string bulletPath = "assets/bullet.png";
+        sf::IntRect bulletRect;
+        bulletTexture = ResourceCache::instance().getRegion(bulletPath, bulletRect);
+        bullets.setTexture(bulletTexture.get(), bulletRect, ResourceCache::instance().getSourceScale(bulletPath));
+
+        player.attachTimers(timers);
+        reset(seed);
+    }
+
+    ~Simulation() {
+        destroyInvaders();
+        delete monster;
+    }
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Starts a new game on level 1. From here on the simulation is a pure
+    // function of `seed` and the inputs passed to step(), which is what lets a
+    // recorded input log replay exactly. All randomness comes from `rng`.
+    void reset(unsigned seed) {
+        rng.seed(seed);
+
+        score = 0;
+        gameOver = false;
+        events = SimEventNone;
+        bullets.clear();
+        destroyInvaders();
+        bombs.clear();
+        explosions.clear();
+        addons.clear();
+        player.respawn();
+
+        delete monster;
+        monster = nullptr;
+        monsterActive = false;
+        monsterScoreGiven = false;
+        monsterHasAppeared = false;
+        showMonsterWarning = false;
+
+        monsterTriggerTime = static_cast<float>(rng[RngSpawns].range(10, 19));
+        restartTimer(TimerAddOnSpawn, 6.f);
+        restartTimer(TimerBombVolley, globalBombInterval);
+        restartTimer(TimerMonsterTrigger, monsterTriggerTime);
+        stopTimer(TimerMonsterWarning);
+        stopTimer(TimerMonsterLifetime);
+        startTick = timers.now();
+
+        levelManager = LevelManager();
+        levelManager.createWave1(invaderArena, invaders);
+        attachInvaders();
+        events |= SimEventWaveStarted;
+    }
+
+    void createInvaderFormation() {
+        destroyInvaders();
+
+        const int rows = 3;
+        const int cols = 10;
+        const float spacingX = 60.f;
+        const float spacingY = 60.f;
+
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                sf::Vector2f startPos(-50.f, 50.f + row * spacingY);
+                sf::Vector2f targetPos(100.f + col * spacingX, 50.f + row * spacingY);
+                if (Invader* invader = invaderArena.create(InvaderAlpha, startPos, targetPos))
+                    invaders.push_back(invader);
+
+            }
+        }
+        attachInvaders();
+    }
+
+    void fireBullets() {
+        sf::Vector2f pos = player.getPosition();
+
+        if (player.isPoweredUp) {
+            int numBullets = 7;
+            float startDeg = -60.f;
+            float endDeg = 60.f;
+            float step = (endDeg - startDeg) / (numBullets - 1);
+
+            for (int i = 0; i < numBullets; ++i) {
+                float angleDeg = startDeg + i * step;
+                float angleRad = angleDeg * 3.14159f / 180.f;
+                sf::Vector2f dir(std::sin(angleRad), -std::cos(angleRad));
+
+                bullets.spawn(pos.x + 30, pos.y, dir);
+            }
+        }
+        else {
+            int bulletCount = 1;
+
+            int level = levelManager.getLevel();
+            if (level == 2) bulletCount = 2;
+            else if (level >= 3) bulletCount = 3;
+
+            if (bulletCount == 1) {
+                bullets.spawn(pos.x + 30.f, pos.y, sf::Vector2f(0.f, -1.f));
+            }
+            else {
+                // Fire bullets in small horizontal spread
+                float spacing = 10.f;
+                float startX = pos.x + 30.f - spacing * (bulletCount - 1) / 2.f;
+
+                for (int i = 0; i < bulletCount; ++i) {
+                    float angle = -10.f + 10.f * i;  // e.g., -10, 0, 10 for 3 bullets
+                    float rad = angle * 3.14159f / 180.f;
+                    sf::Vector2f dir(std::sin(rad), -std::cos(rad));
+                    bullets.spawn(startX + i * spacing, pos.y, dir);
+                }
+            }
+        }
+
+    }
+
+    void step(const TickInput& input, float dt) {
+        if (gameOver)
+            return;
+
+        AllocPhaseScope phase(PhaseOther);
+        timers.advance();
+
+        phase.enter(PhaseInput);
+        if (input.fire)
+            fireBullets();
+
+        phase.enter(PhasePlayer);
+        player.move(input, dt);
+
+        phase.enter(PhaseMonster);
+        // Monster warning phase
+        if (!monsterHasAppeared && !monsterActive && !showMonsterWarning && levelManager.getLevel() == 1 &&
+            timerDue[TimerMonsterTrigger])
+        {
+            showMonsterWarning = true;
+            restartTimer(TimerMonsterWarning, 2.f);
+        }
+
+        // After 2s warning, spawn monster
+        if (showMonsterWarning && timerDue[TimerMonsterWarning]) {
+            timerDue[TimerMonsterWarning] = false;
+            monster = new Monster(sf::Vector2f(300.f, 100.f));
+            monster->attach(timers, rng[RngAI]);
+            monsterActive = true;
+            monsterHasAppeared = true;
+            monsterScoreGiven = false;
+            restartTimer(TimerMonsterLifetime, monsterDuration);
+            showMonsterWarning = false;
+
+            destroyInvaders();
+        }
+
+        phase.enter(PhaseBullets);
+        bullets.integrate(dt);
+        bullets.cullOffscreen();
+
+        // Monster behavior
+        if (monsterActive && monster) {
+            phase.enter(PhaseMonster);
+            monster->step(dt);
+
+            if (monster->isBeamActive() &&
+                monster->getBeamBounds().intersects(player.getBounds()) &&
+                !player.isPoweredUp)
+            {
+                player.lives--;
+                if (player.lives <= 0) {
+                    endGame();
+                    return;
+                }
+            }
+
+            // Bullet hits Monster; only the first bullet in the list counts
+            bullets.fillBoxes(boxes);
+            intersectBatch(monster->getBounds(), boxes, hits);
+            int hitBullet = hits.first();
+            if (hitBullet >= 0) {
+                monster->takeDamage();
+                bullets.kill(static_cast<size_t>(hitBullet));
+                bullets.compact();
+            }
+
+            // Monster destroyed
+            if (monster->isDead()) {
+                score += 80;
+
+                sf::Vector2f monsterPos = monster->getPosition(); 
+                explosions.acquire(monsterPos + sf::Vector2f(40.f, 40.f), explosionExpiry(), 0.5f);
+
+                delete monster;
+                monster = nullptr;
+                monsterActive = false;
+
+                monsterTriggerTime = static_cast<float>(rng[RngSpawns].range(10, 19));
+                restartTimer(TimerMonsterTrigger, monsterTriggerTime);
+
+                events |= SimEventMonsterDestroyed;
+            }
+
+             // Monster dodged (time passed)
+            else if (timerDue[TimerMonsterLifetime] && !monsterScoreGiven) {
+                score += 40;
+                monsterScoreGiven = true;
+                delete monster;
+                monster = nullptr;
+                monsterActive = false;
+
+                monsterTriggerTime = static_cast<float>(rng[RngSpawns].range(10, 19));
+                restartTimer(TimerMonsterTrigger, monsterTriggerTime);
+
+                events |= SimEventMonsterEscaped;
+            }
+
+        }
+
+        if (!monsterActive) {
+            phase.enter(PhaseInvaders);
+            invaderArena.step(dt);
+
+            if (timerDue[TimerBombVolley]) {
+                phase.enter(PhaseBombs);
+                restartTimer(TimerBombVolley, globalBombInterval);
+
+                // Pick up to 3 of the ready invaders to actually drop
+                const int maxDrops = 3;
+                bombScheduler.dispatch(maxDrops, [this](Invader* e) {
+                    sf::Vector2f pos = e->getBombPosition();
+                    bombs.acquire(pos.x, pos.y, e->getBombSpeed());
+                });
+            }
+
+
+        }
+
+        phase.enter(PhaseBombs);
+        for (auto& bomb : bombs)
+            bomb.move(dt);
+
+        bombs.releaseIf([](Bomb& b) {
+            return b.getPosition().y > 600;
+            });
+
+        phase.enter(PhaseAddOns);
+        if (timerDue[TimerAddOnSpawn]) {
+            Pcg32& spawns = rng[RngSpawns];
+            float x = static_cast<float>(spawns.below(760));
+            int type = static_cast<int>(spawns.below(3));
+            if (type == 0) addons.acquire<PowerUpAddOn>(x);
+            else if (type == 1) addons.acquire<DangerAddOn>(x);
+            else addons.acquire<ExtraLifeAddOn>(x);
+            restartTimer(TimerAddOnSpawn, 6.f);
+        }
+
+        boxes.clear();
+        for (auto& addon : addons) {
+            addon.fall(dt);
+            boxes.push(addon.getBounds());
+        }
+        phase.enter(PhaseCollisions);
+        intersectBatch(player.getBounds(), boxes, hits);
+
+        for (size_t i = 0; i < addons.size(); ++i) {
+            AddOn& addon = addons[i];
+            if (hits.test(i)) {
+                addon.applyEffect(player, score, bullets);
+                if (player.lives <= 0) {
+                    endGame();
+                    return;
+                }
+            }
+            else if (addon.isOutOfScreen() && addon.isDangerous()) {
+                score += 5;
+            }
+        }
+
+        // release() moves the last add-on into slot i, so go from the back:
+        // whatever lands in slot i has already been looked at
+        for (size_t i = addons.size(); i-- > 0;) {
+            if (hits.test(i) || addons[i].isOutOfScreen())
+                addons.release(&addons[i]);
+        }
+
+        if (!monsterActive) {
+            phase.enter(PhaseCollisions);
+            bool invaderKilled = false;
+
+            // A normal wave is cheapest as one batch scan per bullet; big
+            // formations go through the grid so each bullet only looks at the
+            // cells it overlaps. Bullet hits only one invader (the first in the list).
+            const bool useGrid = bullets.size() * invaders.size() > GridPairThreshold;
+            if (useGrid) {
+                invaderBounds.clear();
+                for (auto* e : invaders)
+                    invaderBounds.push_back(e->getBounds());
+                invaderGrid.rebuild(invaderBounds);
+            }
+            else {
+                boxes.clear();
+                for (auto* e : invaders)
+                    boxes.push(e->getBounds());
+            }
+
+            for (size_t i = 0; i < bullets.size(); ++i) {
+                int hit;
+                if (useGrid) {
+                    hit = invaderGrid.findFirstHit(bullets.getBounds(i));
+                }
+                else {
+                    intersectBatch(bullets.getBounds(i), boxes, hits);
+                    hit = hits.first();
+                }
+                if (hit < 0)
+                    continue;
+
+                size_t j = static_cast<size_t>(hit);
+                invaders[j]->takeDamage();
+                bullets.kill(i);
+
+                if (invaders[j]->isDead()) {
+                    score += invaders[j]->getScoreValue();
+
+                    explosions.acquire(invaders[j]->getPosition(), explosionExpiry());
+                    // Later bullets pass through to whatever is behind it
+                    if (useGrid) invaderGrid.disable(j);
+                    else boxes.disable(j);
+                    invaderKilled = true;
+                }
+            }
+
+            bullets.compact();
+            if (invaderKilled)
+                removeDeadInvaders();
+
+            if (!player.isPoweredUp) {
+                boxes.clear();
+                for (auto* e : invaders)
+                    boxes.push(e->getBounds());
+                intersectBatch(player.getBounds(), boxes, hits);
+
+                for (size_t j = 0; j < invaders.size(); ++j) {
+                    if (!hits.test(j))
+                        continue;
+                    invaders[j]->setPosition(-100, -100);
+                    player.lives--;
+                    if (player.lives <= 0) {
+                        endGame();
+                        return;
+                    }
                 }
             }
+
+            if (invaders.empty()) {
+                phase.enter(PhaseInvaders);
+                invaderArena.rewind();
+                levelManager.nextWaveOrLevel(invaderArena, invaders);
+                attachInvaders();
+                events |= SimEventWaveStarted;
+            }
+            else {
+                levelManager.waveJustChanged = false;
+            }
         }
-    }
-    //triangle
-    void createWave2(std::vector<Invader*>& invaders) {
-        const int rows = 5;
-        const float spacingX = 60.f;
-        const float spacingY = 60.f;
-        const float centerX = 400.f;
 
-        for (int row = 0; row < rows; ++row) {
-            int numInRow = 2 * row + 1;
-            float startX = centerX - (numInRow / 2.f) * spacingX;
+        phase.enter(PhaseCollisions);
+        if (!player.isPoweredUp) {
+            boxes.clear();
+            for (const auto& bomb : bombs)
+                boxes.push(bomb.getBounds());
+            intersectBatch(player.getBounds(), boxes, hits);
 
-            for (int i = 0; i < numInRow; ++i) {
-                if (i == 0 || i == numInRow - 1 || row == rows - 1) {
-                    sf::Vector2f startPos(850.f, 50.f + row * spacingY);
-                    sf::Vector2f targetPos(startX + i * spacingX, 50.f + row * spacingY);
-                    invaders.push_back(new AlphaInvader(startPos, targetPos));
+            for (size_t i = 0; i < bombs.size(); ++i) {
+                if (!hits.test(i))
+                    continue;
+                bombs[i].setPosition(-100, -100);
+                player.lives--;
+                if (player.lives <= 0) {
+                    endGame();
+                    return;
                 }
             }
         }
-    }
-    void createLevel1Wave3_Mirror(std::vector<Invader*>& invaders) {
-        const int rows = 5;
-        const float spacingY = 60.f;
 
-        for (int i = 0; i < rows; ++i) {
-            float y = 80.f + i * spacingY;
+        phase.enter(PhaseExplosions);
+        if (!explosions.empty()) {
+            uint64_t now = timers.now();
+            explosions.releaseIf([now](const Explosion& e) { return e.isFinished(now); });
+        }
+    }
 
-            // Left side enemy ? moves right to center
-            sf::Vector2f startLeft(-50.f, y);
-            sf::Vector2f targetLeft(300.f, y);
-            invaders.push_back(new AlphaInvader(startLeft, targetLeft));
+    unsigned takeEvents() {
+        unsigned e = events;
+        events = SimEventNone;
+        return e;
+    }
 
-            // Right side enemy ? moves left to center
-            sf::Vector2f startRight(850.f, y);
-            sf::Vector2f targetRight(500.f, y);
-            invaders.push_back(new AlphaInvader(startRight, targetRight));
-        }
+    int getScore() const { return score; }
+    bool isGameOver() const { return gameOver; }
+    uint64_t getTick() const { return timers.now(); }
+    RandomStreams& getRandom() { return rng; }
+    uint64_t getTicksPlayed() const { return timers.now() - startTick; }
+
+    // FNV-1a over the gameplay state, for checking that a replay ended where the
+    // recording did.
+    uint64_t stateHash() const {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](const void* data, size_t n) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < n; ++i) {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+        };
+        auto mixPos = [&mix](sf::Vector2f v) { mix(&v.x, sizeof v.x); mix(&v.y, sizeof v.y); };
+
+        uint64_t ticks = getTicksPlayed();
+        int level = levelManager.getLevel(), wave = levelManager.getWave();
+        mix(&ticks, sizeof ticks);
+        mix(&score, sizeof score);
+        mix(&player.lives, sizeof player.lives);
+        mix(&level, sizeof level);
+        mix(&wave, sizeof wave);
+        mixPos(player.getPosition());
+        for (auto* e : invaders) mixPos(e->getPosition());
+        for (auto& b : bombs) mixPos(b.getPosition());
+        for (size_t i = 0; i < bullets.size(); ++i) mixPos(bullets.getPosition(i));
+        for (const auto& a : addons) mixPos(sf::Vector2f(a.getBounds().left, a.getBounds().top));
+        if (monster) mixPos(monster->getPosition());
+        return h;
+    }
+    bool isMonsterWarningActive() const { return showMonsterWarning; }
+    const LevelManager& getLevelManager() const { return levelManager; }
+
+    void reportPools(std::ostream& out) const {
+        auto line = [&out](const char* name, size_t peak, size_t capacity, size_t rejected) {
+            out << name << " " << peak << "/" << capacity;
+            if (rejected) out << " (" << rejected << " rejected)";
+        };
+        out << "[Pools] peak ";
+        line("bombs", bombs.getHighWater(), bombs.getCapacity(), bombs.getRejected());
+        out << ", ";
+        line("explosions", explosions.getHighWater(), explosions.getCapacity(), explosions.getRejected());
+        out << ", ";
+        line("add-ons", addons.getHighWater(), addons.getCapacity(), addons.getRejected());
+        out << ", invaders " << invaderArena.getHighWater() << "/" << invaderArena.getCapacity()
+            << " in " << invaderArena.getBlockCount() << " blocks\n";
     }
 
-    //circle
-    void createLevel2Wave1(std::vector<Invader*>& invaders) {
-        const int enemyCount = 18;
-        const float radius = 150.f;
-        const float centerX = 400.f;
-        const float centerY = 200.f;
+    // Mutable views for the renderer; entity draw() calls are non-const.
+    Spaceship& getPlayer() { return player; }
+    BulletSystem& getBullets() { return bullets; }
+    const vector<Invader*>& getInvaders() const { return invaders; }
+    AddOnPool& getAddOns() { return addons; }
+    ObjectPool<Bomb>& getBombs() { return bombs; }
+    ObjectPool<Explosion>& getExplosions() { return explosions; }
+    Monster* getMonster() const { return monsterActive ? monster : nullptr; }
+};
 
-        for (int i = 0; i < enemyCount; ++i) {
-            float angle = i * (2 * 3.14159265f / enemyCount);
-            float targetX = centerX + radius * std::cos(angle);
-            float targetY = centerY + radius * std::sin(angle);
+//---------------------------------- Replay ----------------------------------
+// Input logs for reproducing a game tick for tick. A file is
+//
+//     "SSRP" | version | seed | run* | 0 | ticks | score | stateHash
+//
+// where every number is an LEB128 varint. A run packs the input bits of one tick
+// together with how many consecutive ticks used them, as (length << 6) | bits, so
+// holding a key for a few seconds costs two bytes. The trailer lets a replay
+// check that it ended in exactly the recorded state.
+enum ReplayBits : unsigned {
+    ReplayLeft = 1,
+    ReplayRight = 2,
+    ReplayUp = 4,
+    ReplayDown = 8,
+    ReplayFire = 16,
+    ReplayPause = 32,    // the game was paused just before this tick
+    ReplayBitCount = 6
+};
 
-            sf::Vector2f startPos(-50.f, targetY);
-            sf::Vector2f targetPos(targetX, targetY);
+class ReplayWriter {
+private:
+    static const unsigned Version = 1;
+
+    std::ofstream out;
+    unsigned runBits = 0;
+    uint64_t runLength = 0;
+    uint64_t ticks = 0;
+    bool pausePending = false;
+
+    void flushRun() {
+        if (runLength > 0)
+            writeVarint(out, (runLength << ReplayBitCount) | runBits);
+        runLength = 0;
+    }
 
-            if (i % 2 == 0)
-                invaders.push_back(new AlphaInvader(startPos, targetPos));
-            else
-                invaders.push_back(new BetaInvader(startPos, targetPos));
+public:
+    ~ReplayWriter() {
+        if (isOpen()) out.close();
+    }
+
+    bool begin(const std::string& path, unsigned seed) {
+        if (isOpen()) out.close();
+        out.open(path, ios::binary | ios::trunc);
+        if (!out) {
+            std::cerr << "[ERROR] Could not write replay: " << path << "\n";
+            return false;
         }
+        out.write("SSRP", 4);
+        writeVarint(out, Version);
+        writeVarint(out, seed);
+        runBits = 0;
+        runLength = 0;
+        ticks = 0;
+        pausePending = false;
+        return true;
     }
-    //diamond
-    void createLevel2Wave2(std::vector<Invader*>& invaders) {
-        const int rows = 7;
-        const int maxCols = 7;
-        const float spacingX = 55.f;
-        const float spacingY = 55.f;
-        const float centerX = 400.f;
 
-        for (int row = 0; row < rows; ++row) {
-            int half = rows / 2;
-            int numInRow = row <= half ? row * 2 + 1 : (rows - row - 1) * 2 + 1;
+    bool isOpen() const { return out.is_open(); }
 
-            float startX = centerX - (numInRow / 2.f) * spacingX;
-            float y = 60.f + row * spacingY;
+    void markPause() { pausePending = true; }
 
-            for (int col = 0; col < numInRow; ++col) {
+    void record(const TickInput& input) {
+        unsigned bits = (input.left ? ReplayLeft : 0u)
+            | (input.right ? ReplayRight : 0u)
+            | (input.up ? ReplayUp : 0u)
+            | (input.down ? ReplayDown : 0u)
+            | (input.fire ? ReplayFire : 0u)
+            | (pausePending ? ReplayPause : 0u);
+        pausePending = false;
 
-                if (col != 0 && col != numInRow - 1)
-                    continue;
+        if (bits != runBits) {
+            flushRun();
+            runBits = bits;
+        }
+        runLength++;
+        ticks++;
+    }
 
-                float x = startX + col * spacingX;
+    // Writes the trailer and closes the file.
+    void finish(int score, uint64_t stateHash) {
+        if (!isOpen())
+            return;
+        flushRun();
+        writeVarint(out, 0);
+        writeVarint(out, ticks);
+        writeVarint(out, static_cast<uint64_t>(score));
+        writeVarint(out, stateHash);
+        out.close();
+    }
+};
 
+class ReplayReader {
+private:
+    std::ifstream in;
+    unsigned seed = 0;
+    unsigned runBits = 0;
+    uint64_t runLeft = 0;
+    bool ended = false;
+    bool corrupt = false;
+    bool pausedBefore = false;
+
+    uint64_t expectedTicks = 0;
+    int expectedScore = 0;
+    uint64_t expectedHash = 0;
+    bool hasTrailer = false;
 
-                if ((row + col) % 2 == 0)
-                    invaders.push_back(new AlphaInvader({ 850.f, y }, { x, y }));
-                else
-                    invaders.push_back(new BetaInvader({ 850.f, y }, { x, y }));
-            }
+public:
+    bool open(const std::string& path) {
+        in.open(path, ios::binary);
+        char magic[4] = {};
+        uint64_t version = 0, value = 0;
+        if (!in || !in.read(magic, 4) || std::string(magic, 4) != "SSRP" ||
+            !readVarint(in, version) || version != 1 || !readVarint(in, value))
+        {
+            std::cerr << "[ERROR] Not a replay file: " << path << "\n";
+            return false;
         }
+        seed = static_cast<unsigned>(value);
+        return true;
     }
-    void createLevel2Wave3_SlideInColumns(std::vector<Invader*>& invaders) {
-        const int columns = 5;
-        const int enemiesPerColumn = 4;
-        const float spacingX = 100.f;
-        const float spacingY = 60.f;
-
-        for (int col = 0; col < columns; ++col) {
-            float x = 100.f + col * spacingX;
 
-            for (int row = 0; row < enemiesPerColumn; ++row) {
-                float y = 60.f + row * spacingY;
-
-                if (col % 2 == 0) {
-                    // Left slide-in
-                    invaders.push_back(new BetaInvader({ -50.f, y }, { x, y }));
-                }
-                else {
-                    // Right slide-in
-                    invaders.push_back(new BetaInvader({ 850.f, y }, { x, y }));
+    unsigned getSeed() const { return seed; }
+
+    // Fills in the next tick's input; false once the log is exhausted.
+    bool next(TickInput& input) {
+        if (runLeft == 0) {
+            uint64_t run = 0;
+            if (ended || !readVarint(in, run) || run == 0) {
+                if (!ended && run == 0) {
+                    uint64_t ticks = 0, score = 0, hash = 0;
+                    hasTrailer = readVarint(in, ticks) && readVarint(in, score) && readVarint(in, hash);
+                    expectedTicks = ticks;
+                    expectedScore = static_cast<int>(score);
+                    expectedHash = hash;
                 }
+                ended = true;
+                return false;
+            }
+            runBits = static_cast<unsigned>(run & ((1u << ReplayBitCount) - 1));
+            runLeft = run >> ReplayBitCount;
+            if (runLeft == 0) {
+                // A writer never emits an empty run; the file is corrupt
+                std::cerr << "[ERROR] Corrupt replay: zero-length input run\n";
+                corrupt = true;
+                ended = true;
+                return false;
             }
         }
+        runLeft--;
+        pausedBefore = (runBits & ReplayPause) != 0;
+
+        input.left = (runBits & ReplayLeft) != 0;
+        input.right = (runBits & ReplayRight) != 0;
+        input.up = (runBits & ReplayUp) != 0;
+        input.down = (runBits & ReplayDown) != 0;
+        input.fire = (runBits & ReplayFire) != 0;
+        return true;
     }
 
-    //filled rectangle
-    void createLevel3Wave1(std::vector<Invader*>& invaders) {
-        const int rows = 3;
-        const int cols = 10;
-        const float spacingX = 60.f;
-        const float spacingY = 60.f;
+    // True if the game was paused just before the tick next() last returned.
+    // The simulation never sees pauses, so this is for tooling only.
+    bool wasPausedBefore() const { return pausedBefore; }
 
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                sf::Vector2f start(-50.f, 50.f + row * spacingY);
-                sf::Vector2f target(100.f + col * spacingX, 50.f + row * spacingY);
+    bool isCorrupt() const { return corrupt; }
+    bool hasExpectedResult() const { return hasTrailer; }
+    uint64_t getExpectedTicks() const { return expectedTicks; }
+    int getExpectedScore() const { return expectedScore; }
+    uint64_t getExpectedHash() const { return expectedHash; }
+};
 
-                int choice = (row + col) % 3;
-                if (choice == 0) invaders.push_back(new AlphaInvader(start, target));
-                else if (choice == 1) invaders.push_back(new BetaInvader(start, target));
-                else invaders.push_back(new GammaInvader(start, target));
-            }
-        }
-    }
-    //filled triangle
-    void createLevel3Wave2(std::vector<Invader*>& invaders) {
-        const int rows = 4;
-        const float spacingX = 55.f;
-        const float spacingY = 55.f;
-        const float centerX = 400.f;
+//---------------------------------- ScreenManager ----------------------------------
+// Owns the menu screens and builds each one the first time its state is shown,
+// so its textures load then instead of at startup. Instructions and HighScore
+// are rarely visited; once together they hold more texture memory than the
+// budget, the one shown longest ago is dropped and rebuilt on the next visit.
+class ScreenManager {
+public:
+    using Slot = std::variant<std::monostate, MenuScreen, InstructionScreen, NameInputScreen,
+        PauseScreen, GameOverScreen, HighScoreScreen>;
 
-        for (int row = 0; row < rows; ++row) {
-            int numInRow = 2 * row + 1;
-            float startX = centerX - (numInRow / 2.f) * spacingX;
+    static constexpr size_t DefaultBudgetBytes = 6 * 1024 * 1024;
 
-            for (int col = 0; col < numInRow; ++col) {
-                sf::Vector2f start(850.f, 60.f + row * spacingY);
-                sf::Vector2f target(startX + col * spacingX, 60.f + row * spacingY);
+private:
+    static constexpr size_t StateCount = static_cast<size_t>(GameState::HighScore) + 1;
 
-                int choice = (row + col) % 3;
-                if (choice == 0) invaders.push_back(new AlphaInvader(start, target));
-                else if (choice == 1) invaders.push_back(new BetaInvader(start, target));
-                else invaders.push_back(new GammaInvader(start, target));
-            }
+    struct Entry {
+        Slot screen;
+        std::vector<std::string> textures;  // cache entries first loaded by this screen
+        size_t bytes = 0;
+        unsigned long long lastShown = 0;
+    };
+
+    std::array<Entry, StateCount> entries;
+    HighScoreManager& scores;
+    size_t budgetBytes;
+    unsigned long long frame = 0;
+    size_t builds = 0;
+    size_t evictions = 0;
+    size_t redraws = 0;
+
+    GameState lastRun = GameState::Playing;
+    bool focused = true;
+    size_t timeouts = 0;
+
+    // Idle waits: how long a static screen may go without update(), and how
+    // often the wait checks for input. A background window checks 10x less often.
+    static constexpr int IdleTimeoutMs = 1000;
+    static constexpr int FocusedSliceMs = 10;
+    static constexpr int BackgroundSliceMs = 100;
+
+    // SFML 2's waitEvent() can't time out, so the bounded wait polls and sleeps
+    // in short slices. False if nothing arrived within the timeout.
+    static bool waitEventFor(sf::RenderWindow& window, sf::Event& event, sf::Time timeout, sf::Time slice) {
+        sf::Clock clock;
+        while (window.isOpen()) {
+            if (window.pollEvent(event))
+                return true;
+            if (clock.getElapsedTime() >= timeout)
+                return false;
+            sf::sleep(slice);
         }
+        return false;
     }
-    //filled circle-> require modification
-    void createLevel3Wave3(std::vector<Invader*>& invaders) {
-        const float centerX = 400.f;
-        const float centerY = 200.f;
-        const float maxRadius = 150.f;
-        const int rings = 3; // Number of concentric rings
-        const int baseEnemies = 6; // Enemies in innermost ring
 
-        for (int r = 1; r <= rings; ++r) {
-            float radius = (r / static_cast<float>(rings)) * maxRadius;
-            int enemiesInRing = baseEnemies + r * 2; // Increase enemies for outer rings
+    static bool isEvictable(GameState state) {
+        return state == GameState::Instructions || state == GameState::HighScore;
+    }
 
-            for (int i = 0; i < enemiesInRing; ++i) {
-                float angle = i * (2 * 3.14159265f / enemiesInRing);
-                float x = centerX + radius * std::cos(angle);
-                float y = centerY + radius * std::sin(angle);
+    void build(GameState state, Entry& entry) {
+        ResourceCache& cache = ResourceCache::instance();
+        std::vector<std::string> before = cache.getTexturePaths();
+
+        switch (state) {
+        case GameState::Menu:         entry.screen.emplace<MenuScreen>(); break;
+        case GameState::Instructions: entry.screen.emplace<InstructionScreen>(); break;
+        case GameState::NameInput:    entry.screen.emplace<NameInputScreen>(); break;
+        case GameState::Paused:       entry.screen.emplace<PauseScreen>(); break;
+        case GameState::GameOver:     entry.screen.emplace<GameOverScreen>(); break;
+        case GameState::HighScore:    entry.screen.emplace<HighScoreScreen>(scores); break;
+        case GameState::Playing:      return;   // Game draws the simulation itself
+        }
+        builds++;
+
+        std::vector<std::string> after = cache.getTexturePaths();
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        entry.textures.clear();
+        std::set_difference(after.begin(), after.end(), before.begin(), before.end(),
+            std::back_inserter(entry.textures));
+        entry.bytes = cache.getTextureBytes(entry.textures);
+    }
 
-                sf::Vector2f startPos(-50.f, y); // Enter from left
-                sf::Vector2f targetPos(x, y);
+    void evict(Entry& entry) {
+        entry.screen.emplace<std::monostate>();
+        ResourceCache::instance().release(entry.textures);
+        entry.textures.clear();
+        entry.bytes = 0;
+        evictions++;
+    }
 
-                // Alternate types for visual variety
-                if ((i + r) % 3 == 0)
-                    invaders.push_back(new AlphaInvader(startPos, targetPos));
-                else if ((i + r) % 3 == 1)
-                    invaders.push_back(new BetaInvader(startPos, targetPos));
-                else
-                    invaders.push_back(new GammaInvader(startPos, targetPos));
+    // Drops evictable screens other than current, oldest first, until the
+    // rest fit the budget.
+    void enforceBudget(GameState current) {
+        for (;;) {
+            size_t resident = 0;
+            Entry* oldest = nullptr;
+            for (size_t i = 0; i < StateCount; ++i) {
+                GameState state = static_cast<GameState>(i);
+                Entry& entry = entries[i];
+                if (!isEvictable(state) || std::holds_alternative<std::monostate>(entry.screen))
+                    continue;
+                resident += entry.bytes;
+                if (state != current && (!oldest || entry.lastShown < oldest->lastShown))
+                    oldest = &entry;
             }
+            if (resident <= budgetBytes || !oldest)
+                return;
+            evict(*oldest);
         }
     }
 
+    template <class T>
+    void dispatch(T& screen, sf::RenderWindow& window, const sf::Event& event, GameState& state) {
+        switch (event.type) {
+        case sf::Event::Closed:
+            window.close();
+            break;
+        case sf::Event::LostFocus:
+            focused = false;
+            break;
+        case sf::Event::GainedFocus:
+        case sf::Event::Resized:
+            focused = true;
+            screen.markDirty();
+            break;
+        default:
+            screen.handleEvent(event, state);
+            break;
+        }
+    }
 
-    //filled diamond
-    void createLevel3Wave4(std::vector<Invader*>& invaders) {
-        const int rows = 7;
-        const float spacingX = 55.f;
-        const float spacingY = 55.f;
-        const float centerX = 400.f;
-
-        for (int row = 0; row < rows; ++row) {
-            int half = rows / 2;
-            int numInRow = row <= half ? row * 2 + 1 : (rows - row - 1) * 2 + 1;
-
-            float startX = centerX - (numInRow / 2.f) * spacingX;
-            float y = 60.f + row * spacingY;
+    void runScreen(std::monostate&, sf::RenderWindow&, GameState&) {}
 
-            for (int i = 0; i < numInRow; ++i) {
-                sf::Vector2f start(850.f, y);
-                sf::Vector2f target(startX + i * spacingX, y);
+    // Unless the screen is dirty, or animating in the foreground, this sleeps
+    // until the next input or the idle timeout, whichever comes first; update()
+    // then still runs, but nothing is redrawn unless it marked the screen dirty.
+    template <class T>
+    void runScreen(T& screen, sf::RenderWindow& window, GameState& state) {
+        GameState shown = state;
+        bool live = focused && screen.isAnimating();
+        sf::Event event;
+        if (!live && !screen.isDirty()) {
+            sf::Time slice = sf::milliseconds(focused ? FocusedSliceMs : BackgroundSliceMs);
+            if (waitEventFor(window, event, sf::milliseconds(IdleTimeoutMs), slice))
+                dispatch(screen, window, event, state);
+            else
+                timeouts++;
+            if (!window.isOpen())
+                return;
+        }
+        // Events after a state change belong to the next screen
+        while (state == shown && window.pollEvent(event))
+            dispatch(screen, window, event, state);
+        if (state != shown || !window.isOpen())
+            return;
 
-                int choice = (row + i) % 3;
-                if (choice == 0) invaders.push_back(new AlphaInvader(start, target));
-                else if (choice == 1) invaders.push_back(new BetaInvader(start, target));
-                else invaders.push_back(new GammaInvader(start, target));
-            }
+        screen.update(state);
+        if (live || screen.isDirty()) {
+            screen.render(window);
+            screen.clearDirty();
+            redraws++;
         }
     }
 
-    void nextWaveOrLevel(std::vector<Invader*>& invaders) {
-        if (currentLevel == 1 && currentWave == 1) {
-            advanceWave();
-            createWave2(invaders);  
-        }
-        else if (currentLevel == 1 && currentWave == 2) {
-            advanceWave();
-            createLevel1Wave3_Mirror(invaders);  
-        }
-        else if (currentLevel == 2 && currentWave == 1) {
-            advanceWave();
-            createLevel2Wave2(invaders);  
-        }
-        else if (currentLevel == 2 && currentWave == 2) {
-            advanceWave();
-            createLevel2Wave3_SlideInColumns(invaders);  
-        }
-        else if (currentLevel == 3 && currentWave == 1) {
-            advanceWave();
-            createLevel3Wave2(invaders); 
-        }
-        else if (currentLevel == 3 && currentWave == 2) {
-            advanceWave();
-            createLevel3Wave4(invaders);  
-        }
-        else {
-            advanceWave();
-            if (currentLevel == 2)
-                createLevel2Wave1(invaders);
-            else if (currentLevel == 3)
-                createLevel3Wave1(invaders);
+public:
+    explicit ScreenManager(HighScoreManager& scoreManager, size_t budget = DefaultBudgetBytes)
+        : scores(scoreManager), budgetBytes(budget) {}
+
+    // The screen for state, built on first use. Playing has none.
+    Slot& acquire(GameState state) {
+        Entry& entry = entries[static_cast<size_t>(state)];
+        if (std::holds_alternative<std::monostate>(entry.screen)) {
+            build(state, entry);
+            enforceBudget(state);
         }
+        entry.lastShown = frame;
+        return entry.screen;
     }
 
+    template <class T>
+    T& get(GameState state) {
+        return std::get<T>(acquire(state));
+    }
 
-    void updateDisplay(sf::RenderWindow& window) {
-        sf::Font font;
-        if (!font.loadFromFile("assets/Orbitron-Regular.ttf")) return;
+    // Events, update and render of the screen for state. When the screen
+    // switches state, the one left behind becomes a candidate for eviction.
+    void runFrame(sf::RenderWindow& window, GameState& state) {
+        GameState shown = state;
+        bool entering = shown != lastRun;
+        lastRun = shown;
+        frame++;
+        std::visit([&](auto& screen) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(screen)>, std::monostate>) {
+                if (entering) screen.markDirty();
+            }
+            runScreen(screen, window, state);
+        }, acquire(shown));
+        if (state != shown)
+            enforceBudget(state);
+    }
 
-        sf::Text levelText;
-        levelText.setFont(font);
-        levelText.setCharacterSize(16);
-        levelText.setFillColor(sf::Color::Cyan);
-        levelText.setPosition(320, 10);
-        levelText.setString("Level " + std::to_string(currentLevel) + " - Wave " + std::to_string(currentWave));
-        window.draw(levelText);
+    // Game reports focus changes it sees while it owns the event queue.
+    void setFocused(bool hasFocus) { focused = hasFocus; }
+
+    // Called when Game takes over the window, so the next screen shown
+    // counts as entered even if it is the one that was up before.
+    void leave() { lastRun = GameState::Playing; }
+
+    void report(std::ostream& out) const {
+        size_t resident = 0, built = 0;
+        for (const auto& entry : entries) {
+            if (std::holds_alternative<std::monostate>(entry.screen)) continue;
+            resident += entry.bytes;
+            built++;
+        }
+        out << "[Screens] resident: " << built
+            << ", built: " << builds
+            << ", evicted: " << evictions
+            << ", frames: " << frame
+            << ", redraws: " << redraws
+            << ", idle timeouts: " << timeouts
+            << ", textures: " << resident / 1024 << " KiB\n";
     }
 };
 
-
 //---------------------------------- Game ----------------------------------
+// SFML frontend: owns the window and screens, turns keyboard state into a
+// TickInput for the Simulation and draws whatever the simulation holds.
 class Game
 {
 private:
     sf::RenderWindow window;
-    Spaceship player;
-    vector<Bullet> bullets;
-    sf::Texture bulletTexture;
-    vector<Invader*> invaders;
-    sf::Texture InvaderTexture;
-    vector<AddOn*> addons;
-    vector<Bomb> bombs;
-    sf::Texture bombTexture;
+    Simulation sim;
     GameState currentState;
-    Screen* currentScreen;
-    MenuScreen menuScreen;
-    InstructionScreen instructionScreen;
-    GamePlayScreen gamePlayScreen;
-    PauseScreen pauseScreen;
-    GameOverScreen gameOverScreen;
     HighScoreManager highScoreManager;
-    HighScoreScreen highScoreScreen{ highScoreManager };
-    NameInputScreen nameInputScreen;
-
-    std::vector<Explosion> explosions;
+    ScreenManager screens{ highScoreManager };
 
-    LevelManager levelManager;
     sf::Text waveText;
     sf::Clock waveTextClock;
     bool showWaveText = false;
 
-    sf::Clock InvaderClock, addonClock;
+    sf::Clock frameClock;
+    float accumulator = 0.f;
+    float renderAlpha = 1.f;    // how far the frame is between the last two ticks
+    bool ticking = false;       // false while a menu or pause screen is up
     string playerName;
     bool gameStarting = false;
     sf::Clock gameStartClock;
-    sf::Font font;
-    sf::Text scoreText, livesText;
-    int score;
-
-
-    Monster* monster = nullptr;
-    bool monsterActive = false;
-    sf::Clock monsterTriggerClock;
-    sf::Clock monsterLifetimeClock;
-    float monsterDuration = 25.f;
-    bool monsterScoreGiven = false;
-    float monsterTriggerTime = 10.f + rand() % 10; // Random between 10-20s
-    bool showMonsterWarning = false;
+    std::shared_ptr<sf::Font> font;
+    Hud hud;
+    bool firePressed = false;
 
-    sf::Clock globalBombClock;
-    float globalBombInterval = 1.5f; // Try to drop bombs every 1.5 seconds
+    SpriteBatch batch;
+    bool showRenderStats = false;   // F3 toggles the draw-call overlay
 
-    sf::Clock monsterWarningClock;
     sf::Text monsterMessage;
     sf::Clock monsterMessageClock;
     bool showMonsterMessage = false;
-    bool monsterHasAppeared = false;
 
+    std::string recordPath;     // empty unless started with --record
+    ReplayWriter recorder;
+
+    // Runs before the first screens are built, so their texture requests are
+    // all cache hits (gameplay sprites already come from the atlas main() loads).
+    // Shows a progress bar meanwhile.
+    void preloadAssets() {
+        sf::RectangleShape barBack(sf::Vector2f(400.f, 12.f));
+        barBack.setPosition(200.f, 294.f);
+        barBack.setFillColor(sf::Color(60, 60, 60));
+        sf::RectangleShape bar(sf::Vector2f(0.f, 12.f));
+        bar.setPosition(200.f, 294.f);
+        bar.setFillColor(sf::Color::Cyan);
+
+        sf::Clock clock;
+        ResourceCache::instance().preload(startupImagePaths(), [&](size_t done, size_t total) {
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed)
+                    window.close();
+            }
+            bar.setSize(sf::Vector2f(400.f * done / total, 12.f));
+            window.clear();
+            window.draw(barBack);
+            window.draw(bar);
+            window.display();
+        });
+        std::cout << "[Startup] assets ready in " << clock.getElapsedTime().asMilliseconds()
+            << " ms on " << ParallelDecoder::defaultWorkers() << " threads\n";
+    }
 
-public:
-    Game() : window(sf::VideoMode(800, 600), "Space Invaders"), score(0) {
-        window.setFramerateLimit(60);
-        if (!font.loadFromFile("assets/Orbitron-Regular.ttf")) {
-            cerr << "[ERROR] Could not load font.\n";
-        }
-        if (!bulletTexture.loadFromFile("assets/bullet.png")) {
-            cerr << "[ERROR] Could not load bullet.png, fallback to shape.\n";
+    void finishRecording() {
+        if (recorder.isOpen()) {
+            recorder.finish(sim.getScore(), sim.stateHash());
+            std::cout << "Replay saved to " << recordPath << "\n";
         }
-        if (!bombTexture.loadFromFile("assets/bomb.png")) {
-            cerr << "[ERROR] Could not load bomb.png\n";
-        }
-        currentState = GameState::Menu;
-        currentScreen = &menuScreen;
-
+    }
 
 
-        scoreText.setFont(font);
-        scoreText.setCharacterSize(18);
-        scoreText.setFillColor(sf::Color::White);
-        scoreText.setPosition(10, 10);
+public:
+    explicit Game(const std::string& recordTo = "")
+        : window(sf::VideoMode(800, 600), "Space Invaders"), recordPath(recordTo)
+    {
+        preloadAssets();
+        window.setFramerateLimit(60);
+        font = ResourceCache::instance().getFont("assets/Orbitron-Regular.ttf");
+        currentState = GameState::Menu;
 
-        livesText.setFont(font);
-        livesText.setCharacterSize(18);
-        livesText.setFillColor(sf::Color::White);
-        livesText.setPosition(680, 10);
 
-        srand(static_cast<unsigned>(time(0)));
-        waveText.setFont(font);
+        waveText.setFont(*font);
         waveText.setCharacterSize(24);
         waveText.setFillColor(sf::Color::Yellow);
         waveText.setPosition(280, 300);
 
 
-        levelManager.createWave1(invaders);
+        sim.takeEvents();
         showWaveText = true;
         waveText.setString("LEVEL 1 - WAVE 1");
         waveTextClock.restart();
@@ -1747,73 +5539,44 @@ public:
 
     }
 
-    void resetGame() {
-        score = 0;
-        bullets.clear();
-        for (auto* e : invaders) delete e;
-        invaders.clear();
-        bombs.clear();
-        addons.clear();
-        player.lives = 3;
-        player.isPoweredUp = false;
-        player.isOnFire = false;
+    ~Game() {
+        finishRecording();
+    }
+
+    void report(std::ostream& out) const {
+        screens.report(out);
+        FrameArena::instance().report(out);
+        allocReport(out);
+    }
+
+    void resetGame() {
+        unsigned seed = static_cast<unsigned>(time(0));
+        finishRecording();
+        sim.reset(seed);
+        if (!recordPath.empty())
+            recorder.begin(recordPath, seed);
 
-        levelManager.createWave1(invaders);
+        sim.takeEvents();
         showWaveText = true;
         waveText.setString("LEVEL 1 - WAVE 1");
         waveTextClock.restart();
 
-        monsterMessage.setFont(font);
+        monsterMessage.setFont(*font);
         monsterMessage.setCharacterSize(26);
         monsterMessage.setFillColor(sf::Color::White);
         monsterMessage.setOutlineColor(sf::Color::Black);
         monsterMessage.setOutlineThickness(1.5f);
         monsterMessage.setPosition(200.f, 280.f);
-
-
-        if (monster) {
-            delete monster;
-            monster = nullptr;
-            monsterActive = false;
-            monsterTriggerClock.restart();
-            monsterTriggerTime = 10.f + rand() % 10;
-        }
-
-
-
-    }
-    void createInvaderFormation() {
-        for (auto* e : invaders) delete e;
-        invaders.clear();
-
-        const int rows = 3;
-        const int cols = 10;
-        const float spacingX = 60.f;
-        const float spacingY = 60.f;
-
-        int level = levelManager.getLevel();
-        int wave = levelManager.getWave();
-
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                sf::Vector2f startPos(-50.f, 50.f + row * spacingY);
-                sf::Vector2f targetPos(100.f + col * spacingX, 50.f + row * spacingY);
-                invaders.push_back(new AlphaInvader(startPos, targetPos));
-
-            }
-        }
     }
 
     void start() {
         while (window.isOpen()) {
             switch (currentState) {
             case GameState::NameInput:
-                nameInputScreen.handleEvents(window, currentState);
-                nameInputScreen.update(currentState);
-                nameInputScreen.render(window);
+                screens.runFrame(window, currentState);
 
                 if (currentState == GameState::Playing) {
-                    playerName = nameInputScreen.getPlayerName();
+                    playerName = screens.get<NameInputScreen>(GameState::NameInput).getPlayerName();
 
                     // Check if name is empty
                     if (playerName.empty()) {
@@ -1822,13 +5585,6 @@ public:
                     }
                     else {
                         // Name is valid, proceed with starting the game
-                        score = 0;
-                        bullets.clear();
-                        addons.clear();
-                        player.lives = 3;
-                        player.isPoweredUp = false;
-                        player.isOnFire = false;
-
                         resetGame();
                         gameStarting = true;
                         gameStartClock.restart();
@@ -1836,433 +5592,534 @@ public:
                 }
                 break;
             case GameState::Playing:
+                // Coming back from a menu or pause: don't replay the time spent away
+                if (!ticking) {
+                    frameClock.restart();
+                    accumulator = 0.f;
+                    ticking = true;
+                    screens.leave();
+                }
                 handleEvents();
                 update();
                 render();
                 break;
 
             case GameState::Paused:
-                currentScreen = &pauseScreen;
-                [[fallthrough]];
             case GameState::Menu:
             case GameState::Instructions:
             case GameState::GameOver:
             case GameState::HighScore:
-                currentScreen->handleEvents(window, currentState);
-                currentScreen->update(currentState);
-                currentScreen->render(window);
+                screens.runFrame(window, currentState);
                 break;
             }
 
-            // Update screen pointer
-            if (currentState == GameState::Instructions)
-                currentScreen = &instructionScreen;
-            else if (currentState == GameState::Menu)
-                currentScreen = &menuScreen;
-            else if (currentState == GameState::Paused)
-                currentScreen = &pauseScreen;
-            else if (currentState == GameState::GameOver)
-                currentScreen = &gameOverScreen;
-            else if (currentState == GameState::HighScore)
-                currentScreen = &highScoreScreen;
+            if (currentState != GameState::Playing)
+                ticking = false;
+
+            FrameArena::instance().endFrame();
+            allocEndFrame(std::cout);
         }
     }
 
 
     void handleEvents() {
+        AllocPhaseScope phase(PhaseInput);
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed)
                 window.close();
 
+            // Tracked so screens shown after this throttle while in the background
+            if (event.type == sf::Event::LostFocus) {
+                screens.setFocused(false);
+            }
+            else if (event.type == sf::Event::GainedFocus) {
+                screens.setFocused(true);
+            }
+
             if (event.type == sf::Event::KeyPressed) {
                 if (event.key.code == sf::Keyboard::Space) {
-                    fireBullets();
+                    firePressed = true;
                 }
                 else if (event.key.code == sf::Keyboard::Escape) {
                     currentState = GameState::Paused;
+                    if (recorder.isOpen()) recorder.markPause();
+                }
+                else if (event.key.code == sf::Keyboard::F3) {
+                    showRenderStats = !showRenderStats;
                 }
             }
         }
     }
 
-    void fireBullets() {
-        sf::Vector2f pos = player.getPosition();
-
-        if (player.isPoweredUp) {
-            int numBullets = 7;
-            float startDeg = -60.f;
-            float endDeg = 60.f;
-            float step = (endDeg - startDeg) / (numBullets - 1);
-
-            for (int i = 0; i < numBullets; ++i) {
-                float angleDeg = startDeg + i * step;
-                float angleRad = angleDeg * 3.14159f / 180.f;
-                sf::Vector2f dir(std::sin(angleRad), -std::cos(angleRad));
+    TickInput readInput() const {
+        TickInput input;
+        input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+        input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+        input.up = sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
+        input.down = sf::Keyboard::isKeyPressed(sf::Keyboard::Down);
+        input.fire = firePressed;
+        return input;
+    }
 
-                bullets.emplace_back(pos.x + 30, pos.y, dir, &bulletTexture);
-            }
+    // Runs as many fixed ticks as the elapsed frame time covers. The leftover
+    // fraction of a tick becomes the interpolation factor for render().
+    void update() {
+        float frameTime = std::min(frameClock.restart().asSeconds(), 0.25f);
+        accumulator += frameTime;
+
+        TickInput input = readInput();
+        while (accumulator >= Simulation::TickSeconds && !sim.isGameOver()) {
+            if (recorder.isOpen()) recorder.record(input);
+            sim.step(input, Simulation::TickSeconds);
+            accumulator -= Simulation::TickSeconds;
+
+            // A key press fires once, on the first tick that sees it
+            input.fire = false;
+            firePressed = false;
         }
-        else {
-            int bulletCount = 1;
-
-            int level = levelManager.getLevel();
-            if (level == 2) bulletCount = 2;
-            else if (level >= 3) bulletCount = 3;
-
-            if (bulletCount == 1) {
-                bullets.emplace_back(pos.x + 30.f, pos.y, sf::Vector2f(0.f, -1.f), &bulletTexture);
-            }
-            else {
-                // Fire bullets in small horizontal spread
-                float spacing = 10.f;
-                float startX = pos.x + 30.f - spacing * (bulletCount - 1) / 2.f;
-
-                for (int i = 0; i < bulletCount; ++i) {
-                    float angle = -10.f + 10.f * i;  // e.g., -10, 0, 10 for 3 bullets
-                    float rad = angle * 3.14159f / 180.f;
-                    sf::Vector2f dir(std::sin(rad), -std::cos(rad));
-                    bullets.emplace_back(startX + i * spacing, pos.y, dir, &bulletTexture);
-                }
-            }
+        renderAlpha = accumulator / Simulation::TickSeconds;
+
+        AllocPhaseScope phase(PhaseHud);
+        unsigned events = sim.takeEvents();
+        if (events & SimEventGameOver) {
+            finishRecording();
+            highScoreManager.addNewScore(playerName, sim.getScore());
+            screens.get<GameOverScreen>(GameState::GameOver).setFinalScore(sim.getScore());
+            currentState = GameState::GameOver;
+            return;
+        }
+        if (events & SimEventWaveStarted) {
+            const LevelManager& levels = sim.getLevelManager();
+            showWaveText = true;
+            ScratchString s = scratchString("LEVEL ");
+            appendNumber(s, levels.getLevel()).append(" - WAVE ");
+            waveText.setString(appendNumber(s, levels.getWave()).c_str());
+            waveTextClock.restart();
+        }
+        if (events & (SimEventMonsterDestroyed | SimEventMonsterEscaped)) {
+            monsterMessage.setString(events & SimEventMonsterDestroyed ? "Monster Destroyed!" : "Monster Escaped!");
+            monsterMessage.setPosition(200, 210);
+            monsterMessageClock.restart();
+            showMonsterMessage = true;
         }
 
+        hud.setScore(sim.getScore());
+        hud.setLives(sim.getPlayer().lives);
+        hud.setLevel(sim.getLevelManager().getLevel(), sim.getLevelManager().getWave());
+        hud.setLeaderboard(highScoreManager);
     }
 
-    void update() {
-        float dt = 1.0f / 60.f;
-        if (InvaderClock.getElapsedTime().asSeconds() > 0.016f)
-            dt = InvaderClock.restart().asSeconds();
 
-        player.move();
+    void render() {
+        AllocPhaseScope phase(PhaseRender);
+        window.clear();
+        batch.resetStats();
+
+        // Entity layer: one draw call per texture
+        sim.getPlayer().draw(batch, renderAlpha);
+        sim.getBullets().draw(batch, renderAlpha);
+        for (auto* e : sim.getInvaders()) e->draw(batch, renderAlpha);
+        for (auto& exp : sim.getExplosions()) {
+            if (!exp.isFinished(sim.getTick()))
+                exp.draw(batch);
+        }
+        for (auto& a : sim.getAddOns()) a.draw(batch, renderAlpha);
+        for (auto& bomb : sim.getBombs()) bomb.draw(batch, renderAlpha);
+        batch.flush(window);
 
-        // Monster warning phase
-        if (!monsterHasAppeared && !monsterActive && !showMonsterWarning && levelManager.getLevel() == 1 &&
-            monsterTriggerClock.getElapsedTime().asSeconds() >= monsterTriggerTime)
-        {
-            showMonsterWarning = true;
-            monsterWarningClock.restart();
+        hud.drawLeaderboard(window);
+        hud.drawCounters(window);
+        if (gameStarting && gameStartClock.getElapsedTime().asSeconds() < 2.f) {
+            hud.drawStarting(window);
+        }
+        else {
+            gameStarting = false;
         }
+        hud.drawLevel(window);
 
-        // After 2s warning, spawn monster
-        if (showMonsterWarning && monsterWarningClock.getElapsedTime().asSeconds() >= 2.f) {
-            monster = new Monster(sf::Vector2f(300.f, 100.f));
-            monsterActive = true;
-            monsterHasAppeared = true;
-            monsterScoreGiven = false;
-            monsterLifetimeClock.restart();
-            showMonsterWarning = false;
+        if (showWaveText && waveTextClock.getElapsedTime().asSeconds() < 2.f) {
+            window.draw(waveText);
+        }
+        else {
+            showWaveText = false;
+        }
+        if (Monster* monster = sim.getMonster()) {
+            monster->draw(batch, renderAlpha);
+            batch.flush(window);
+        }
+        if (sim.isMonsterWarningActive()) {
+            hud.drawMonsterWarning(window);
+        }
+        if (showMonsterMessage && monsterMessageClock.getElapsedTime().asSeconds() <= 2.f) {
+            window.draw(monsterMessage);
+        }
+        else {
+            showMonsterMessage = false;
+        }
 
-            for (auto* inv : invaders) delete inv;
-            invaders.clear();
+        if (showRenderStats) {
+            hud.setRenderStats(batch.getStats());
+            hud.drawRenderStats(window);
         }
 
-        for (auto& b : bullets) b.move();
-        bullets.erase(remove_if(bullets.begin(), bullets.end(), [](Bullet& b) {
-            return b.getPosition().y < -10 || b.getPosition().x < -10 || b.getPosition().x > 810;
-            }), bullets.end());
+        window.display();
+    }
+};
 
-        // Monster behavior
-        if (monsterActive && monster) {
-            monster->update(dt);
+//---------------------------------- Benchmarks ----------------------------------
+// Compares the brute-force bullet x invader scan against SpatialHashGrid and the
+// batch kernel on random formations and checks that all three pick exactly the
+// same invader for every bullet.
+void runBroadphaseBenchmark() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> invX(-50.f, 800.f), invY(20.f, 420.f);
+    std::uniform_real_distribution<float> bulX(0.f, 800.f), bulY(-10.f, 600.f);
+
+    SpatialHashGrid grid;
+    BoxSoA boxes;
+    HitMask hits;
+    const int counts[] = { 50, 100, 500, 1000, 2000, 5000 };
+
+    cout << "entities  brute(us/tick)  grid(us/tick)  " << CollisionKernelName << "(us/tick)  hits\n";
+    for (int n : counts) {
+        std::vector<sf::FloatRect> invaderBoxes, bulletBoxes;
+        for (int i = 0; i < n; ++i) {
+            invaderBoxes.emplace_back(invX(rng), invY(rng), 50.f, 50.f);
+            bulletBoxes.emplace_back(bulX(rng), bulY(rng), 20.f, 20.f);
+        }
 
-            if (monster->isBeamActive() &&
-                monster->getBeamBounds().intersects(player.getBounds()) &&
-                !player.isPoweredUp)
-            {
-                player.lives--;
-                if (player.lives <= 0) {
-                    highScoreManager.addNewScore(playerName, score);
-                    gameOverScreen.setFinalScore(score);
-                    currentState = GameState::GameOver;
-                    return;
-                }
-            }
+        const int iterations = std::max(3, 200000 / n);
+        long long bruteHits = 0, gridHits = 0, kernelHits = 0;
 
-            // Bullet hits Monster
-            for (size_t i = 0; i < bullets.size(); ++i) {
-                if (bullets[i].getBounds().intersects(monster->getBounds())) {
-                    monster->takeDamage();
-                    bullets.erase(bullets.begin() + i);
-                    break;
+        sf::Clock clock;
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& b : bulletBoxes) {
+                for (size_t j = 0; j < invaderBoxes.size(); ++j) {
+                    if (b.intersects(invaderBoxes[j])) { bruteHits += j + 1; break; }
                 }
             }
+        }
+        float bruteUs = clock.restart().asMicroseconds() / static_cast<float>(iterations);
 
-            // Monster destroyed
-            if (monster->isDead()) {
-                score += 80;
-
-                sf::Vector2f monsterPos = monster->getPosition(); 
-                explosions.emplace_back(monsterPos + sf::Vector2f(40.f, 40.f), 0.5f); 
-
-                delete monster;
-                monster = nullptr;
-                monsterActive = false;
-
-                monsterTriggerClock.restart();
-                monsterTriggerTime = 10.f + rand() % 10;
-
-                monsterMessage.setString("Monster Destroyed!");
-                monsterMessage.setPosition(200, 210);
-                monsterMessageClock.restart();
-                showMonsterMessage = true;
+        for (int it = 0; it < iterations; ++it) {
+            grid.rebuild(invaderBoxes);
+            for (const auto& b : bulletBoxes) {
+                int hit = grid.findFirstHit(b);
+                if (hit >= 0) gridHits += hit + 1;
             }
-
-             // Monster dodged (time passed)
-            else if (monsterLifetimeClock.getElapsedTime().asSeconds() >= monsterDuration && !monsterScoreGiven) {
-                score += 40;
-                monsterScoreGiven = true;
-                delete monster;
-                monster = nullptr;
-                monsterActive = false;
-
-                monsterTriggerClock.restart();
-                monsterTriggerTime = 10.f + rand() % 10;
-
-                monsterMessage.setString("Monster Escaped!");
-                monsterMessage.setPosition(200, 210);
-                monsterMessageClock.restart();
-                showMonsterMessage = true;
+        }
+        float gridUs = clock.restart().asMicroseconds() / static_cast<float>(iterations);
+
+        for (int it = 0; it < iterations; ++it) {
+            boxes.clear();
+            for (const auto& b : invaderBoxes)
+                boxes.push(b);
+            for (const auto& b : bulletBoxes) {
+                intersectBatch(b, boxes, hits);
+                kernelHits += hits.first() + 1;
             }
-
         }
+        float kernelUs = clock.restart().asMicroseconds() / static_cast<float>(iterations);
 
-        if (!monsterActive) {
-            for (auto* e : invaders)
-                e->update(dt);
-
-            if (globalBombClock.getElapsedTime().asSeconds() >= globalBombInterval) {
-                globalBombClock.restart();
-
-                std::vector<Invader*> readyInvaders;
-                for (auto* e : invaders) {
-                    if (e->isBombReady()) {
-                        readyInvaders.push_back(e);
-                    }
-                }
-
-                // Shuffle and pick up to 3 to actually drop
-                std::shuffle(readyInvaders.begin(), readyInvaders.end(), std::mt19937(std::random_device{}()));
-
-                int maxDrops = 3;
-                for (int i = 0; i < std::min(maxDrops, static_cast<int>(readyInvaders.size())); ++i) {
-                    sf::Vector2f pos = readyInvaders[i]->getBombPosition();
-                    bombs.emplace_back(pos.x, pos.y, readyInvaders[i]->getBombSpeed(), &bombTexture);
-                    readyInvaders[i]->restartBombTimer();
-                }
+        bool match = bruteHits == gridHits && bruteHits == kernelHits;
+        cout << n << "\t  " << bruteUs << "\t  " << gridUs << "\t  " << kernelUs << "\t "
+            << (match ? "match" : "MISMATCH") << "\n";
+    }
+}
+
+// Times one box against N boxes with sf::FloatRect::intersects, the scalar SoA
+// loop and the SIMD kernel, and checks all three produce the same hit mask.
+// Boxes include zero and negative sizes so the edge cases get compared too.
+void runCollideBenchmark() {
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> pos(-50.f, 800.f), size(-10.f, 60.f);
+
+    BoxSoA boxes;
+    HitMask scalarHits, batchHits;
+    std::vector<uint64_t> rectWords;
+    const int counts[] = { 8, 32, 64, 256, 1024, 4096 };
+    const int queries = 256;
+
+    cout << "kernel: " << CollisionKernelName << "\n";
+    cout << "boxes  intersects(ns/box)  scalar(ns/box)  " << CollisionKernelName << "(ns/box)  masks\n";
+    for (int n : counts) {
+        std::vector<sf::FloatRect> rects, probes;
+        boxes.clear();
+        for (int i = 0; i < n; ++i) {
+            float w = size(rng), h = size(rng);
+            if (i % 17 == 0) w = 0.f;       // degenerate boxes never intersect
+            rects.emplace_back(pos(rng), pos(rng), w, h);
+            boxes.push(rects.back());
+        }
+        for (int q = 0; q < queries; ++q)
+            probes.emplace_back(pos(rng), pos(rng), size(rng), size(rng));
+
+        const int iterations = std::max(3, 2000000 / (n * queries) + 1);
+        const double tests = static_cast<double>(iterations) * queries * n;
+        long long rectCount = 0, scalarCount = 0, batchCount = 0;
+        bool match = true;
+
+        sf::Clock clock;
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& q : probes) {
+                rectWords.assign((n + 63) / 64, 0);
+                for (int i = 0; i < n; ++i)
+                    if (q.intersects(rects[i]))
+                        rectWords[i / 64] |= uint64_t(1) << (i % 64);
+                rectCount += rectWords[0] & 1;
             }
-
-
         }
+        double rectNs = clock.restart().asMicroseconds() * 1000.0 / tests;
 
-        for (auto& bomb : bombs)
-            bomb.move();
-
-        bombs.erase(remove_if(bombs.begin(), bombs.end(), [](Bomb& b) {
-            return b.getPosition().y > 600;
-            }), bombs.end());
-
-        if (addonClock.getElapsedTime().asSeconds() > 6.f) {
-            float x = static_cast<float>(rand() % 760);
-            int type = rand() % 3;
-            if (type == 0) addons.push_back(new PowerUpAddOn(x));
-            else if (type == 1) addons.push_back(new DangerAddOn(x));
-            else addons.push_back(new ExtraLifeAddOn(x));
-            addonClock.restart();
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& q : probes) {
+                intersectScalar(q, boxes, scalarHits);
+                scalarCount += scalarHits.words[0] & 1;
+            }
         }
+        double scalarNs = clock.restart().asMicroseconds() * 1000.0 / tests;
 
-        for (size_t i = 0; i < addons.size();) {
-            AddOn* addon = addons[i];
-            addon->fall();
-
-            if (addon->getBounds().intersects(player.getBounds())) {
-                addon->applyEffect(player, score, currentState, highScoreManager, playerName, bullets);
-                if (player.lives <= 0) {
-                    highScoreManager.addNewScore(playerName, score);
-                    gameOverScreen.setFinalScore(score);
-                    currentState = GameState::GameOver;
-                    return;
-                }
-                delete addon;
-                addons.erase(addons.begin() + i);
-            }
-            else if (addon->isOutOfScreen()) {
-                if (addon->isDangerous()) score += 5;
-                delete addon;
-                addons.erase(addons.begin() + i);
-            }
-            else {
-                ++i;
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& q : probes) {
+                intersectBatch(q, boxes, batchHits);
+                batchCount += batchHits.words[0] & 1;
             }
         }
-
-        if (!monsterActive) {
-            std::vector<size_t> bulletsToErase;
-            std::vector<size_t> invadersToErase;
-
-            for (size_t i = 0; i < bullets.size(); ++i) {
-                for (size_t j = 0; j < invaders.size(); ++j) {
-                    if (bullets[i].getBounds().intersects(invaders[j]->getBounds())) {
-                        invaders[j]->takeDamage();
-                        bulletsToErase.push_back(i);
-
-                        if (invaders[j]->isDead()) {
-                            if (dynamic_cast<AlphaInvader*>(invaders[j])) score += 10;
-                            else if (dynamic_cast<BetaInvader*>(invaders[j])) score += 20;
-                            else if (dynamic_cast<GammaInvader*>(invaders[j])) score += 30;
-
-                            explosions.emplace_back(invaders[j]->getSprite().getPosition());
-                            invadersToErase.push_back(j);
-                        }
-
-                        break;  // Bullet hit only one invader
-                    }
-                }
+        double batchNs = clock.restart().asMicroseconds() * 1000.0 / tests;
+
+        // Full comparison outside the timed loops
+        for (const auto& q : probes) {
+            intersectScalar(q, boxes, scalarHits);
+            intersectBatch(q, boxes, batchHits);
+            for (int i = 0; i < n; ++i) {
+                bool expected = q.intersects(rects[i]);
+                if (scalarHits.test(i) != expected || batchHits.test(i) != expected)
+                    match = false;
             }
+        }
+        match = match && rectCount == scalarCount && rectCount == batchCount;
 
-            // Erase bullets in reverse order to avoid invalidating indices
-            std::sort(bulletsToErase.rbegin(), bulletsToErase.rend());
-            for (size_t idx : bulletsToErase) {
-                if (idx < bullets.size())
-                    bullets.erase(bullets.begin() + idx);
-            }
+        cout << n << "\t  " << rectNs << "\t\t" << scalarNs << "\t\t" << batchNs << "\t "
+            << (match ? "match" : "MISMATCH") << "\n";
+    }
+}
 
-            // Erase and delete invaders
-            std::sort(invadersToErase.rbegin(), invadersToErase.rend());
-            for (size_t idx : invadersToErase) {
-                if (idx < invaders.size()) {
-                    delete invaders[idx];
-                    invaders.erase(invaders.begin() + idx);
-                }
-            }
+// Steps the simulation without a window or GPU. A simple bot sweeps left and right
+// and fires; finished games are restarted so the run can soak for any length.
+void runHeadless(long ticks, unsigned seed) {
+    ResourceCache::instance().setHeadless(true);
 
-            for (auto* e : invaders) {
-                if (e->getBounds().intersects(player.getBounds()) && !player.isPoweredUp) {
-                    e->getSprite().setPosition(-100, -100);
-                    player.lives--;
-                    if (player.lives <= 0) {
-                        highScoreManager.addNewScore(playerName, score);
-                        gameOverScreen.setFinalScore(score);
-                        currentState = GameState::GameOver;
-                        return;
-                    }
-                }
-            }
+    Simulation sim(seed);
+    TickInput input;
+    int gamesPlayed = 0;
+    long totalScore = 0;
 
-            if (invaders.empty()) {
-                levelManager.nextWaveOrLevel(invaders);
-                showWaveText = true;
-                waveText.setString("LEVEL " + std::to_string(levelManager.getLevel()) +
-                    " - WAVE " + std::to_string(levelManager.getWave()));
-                waveTextClock.restart();
-            }
-            else {
-                levelManager.waveJustChanged = false;
-            }
+    sf::Clock clock;
+    for (long t = 0; t < ticks; ++t) {
+        input.left = (t / 180) % 2 == 0;
+        input.right = !input.left;
+        input.fire = t % 16 == 0;
+
+        sim.step(input, Simulation::TickSeconds);
+        sim.takeEvents();
+
+        if (sim.isGameOver()) {
+            gamesPlayed++;
+            totalScore += sim.getScore();
+            sim.reset(seed + gamesPlayed);
         }
+        allocEndFrame(cout);
+    }
+    float seconds = clock.getElapsedTime().asSeconds();
+
+    cout << "ticks: " << ticks
+        << ", seconds: " << seconds
+        << ", ticks/s: " << (seconds > 0.f ? ticks / seconds : 0.f) << "\n"
+        << "games finished: " << gamesPlayed
+        << ", total score: " << totalScore + sim.getScore()
+        << ", level " << sim.getLevelManager().getLevel()
+        << " wave " << sim.getLevelManager().getWave() << "\n";
+    sim.reportPools(cout);
+    allocReport(cout);
+}
+
+// Feeds a recorded input log through a fresh simulation and checks that it ends
+// in the recorded state. Returns false if the file is unreadable or diverges.
+bool runReplay(const std::string& path) {
+    ResourceCache::instance().setHeadless(true);
+
+    ReplayReader reader;
+    if (!reader.open(path))
+        return false;
+
+    Simulation sim(reader.getSeed());
+    TickInput input;
+    int pauses = 0;
+    sf::Clock clock;
+    while (!sim.isGameOver() && reader.next(input)) {
+        if (reader.wasPausedBefore())
+            pauses++;
+        sim.step(input, Simulation::TickSeconds);
+        sim.takeEvents();
+    }
+    float seconds = clock.getElapsedTime().asSeconds();
+
+    cout << "seed: " << reader.getSeed()
+        << ", ticks: " << sim.getTicksPlayed()
+        << ", pauses: " << pauses
+        << ", seconds: " << seconds << "\n"
+        << "score: " << sim.getScore()
+        << ", level " << sim.getLevelManager().getLevel()
+        << " wave " << sim.getLevelManager().getWave() << "\n";
+
+    if (reader.isCorrupt())
+        return false;
+    if (!reader.hasExpectedResult()) {
+        cout << "no trailer (recording was cut short); nothing to verify\n";
+        return true;
+    }
+    bool match = sim.getTicksPlayed() == reader.getExpectedTicks()
+        && sim.getScore() == reader.getExpectedScore()
+        && sim.stateHash() == reader.getExpectedHash();
+    cout << (match ? "replay matches recording\n" : "replay DIVERGED from recording\n");
+    return match;
+}
+
+// Resamples every gameplay sprite to the largest size it is drawn at, writes
+// assets/processed_<name>.png plus the assets/processed.txt manifest the game
+// loads, and reports what each asset saves.
+bool processAssets() {
+    ofstream manifest("assets/processed.txt");
+    if (!manifest) {
+        std::cerr << "[ERROR] Could not write assets/processed.txt\n";
+        return false;
+    }
 
-        for (auto& bomb : bombs) {
-            if (bomb.getBounds().intersects(player.getBounds()) && !player.isPoweredUp) {
-                bomb.setPosition(-100, -100);
-                player.lives--;
-                if (player.lives <= 0) {
-                    highScoreManager.addNewScore(playerName, score);
-                    gameOverScreen.setFinalScore(score);
-                    currentState = GameState::GameOver;
-                    return;
-                }
-            }
+    size_t totalBefore = 0, totalAfter = 0;
+    cout << "asset                       source       processed    texture KiB      file KiB\n";
+    for (const auto& sprite : gameplaySprites()) {
+        sf::Image source;
+        if (!source.loadFromFile(sprite.path)) {
+            std::cerr << "[ERROR] Could not load image: " << sprite.path << "\n";
+            continue;
         }
-
-        if (!explosions.empty()) {
-            for (auto& exp : explosions)
-                exp.update();
-
-            explosions.erase(
-                std::remove_if(explosions.begin(), explosions.end(),
-                    [](const Explosion& e) { return e.isFinished(); }),
-                explosions.end());
+        sf::Vector2u size = source.getSize();
+        float scaleX = sprite.fitPx > 0.f ? sprite.fitPx / size.x : sprite.scaleX;
+        float scaleY = sprite.fitPx > 0.f ? sprite.fitPx / size.y : sprite.scaleY;
+        unsigned width = std::max(1u, static_cast<unsigned>(std::ceil(size.x * scaleX)));
+        unsigned height = std::max(1u, static_cast<unsigned>(std::ceil(size.y * scaleY)));
+        if (width >= size.x && height >= size.y)
+            continue;   // already no larger than it is drawn
+
+        std::string path = sprite.path;
+        std::string file = "assets/processed_" + path.substr(path.find_last_of('/') + 1);
+        if (!resampleImage(source, width, height).saveToFile(file)) {
+            std::cerr << "[ERROR] Could not write " << file << "\n";
+            continue;
         }
-
-        scoreText.setString("Score: " + to_string(score));
-        livesText.setString("Lives: " + to_string(player.lives));
+        manifest << path << " " << file << " " << size.x << " " << size.y << " "
+            << width << " " << height << " " << (sprite.varyingScale ? 1 : 0) << "\n";
+
+        size_t before = static_cast<size_t>(size.x) * size.y * 4;
+        size_t after = static_cast<size_t>(width) * height * 4;
+        totalBefore += before;
+        totalAfter += after;
+
+        ifstream a(path, ios::binary | ios::ate), b(file, ios::binary | ios::ate);
+        std::string sourceDims = std::to_string(size.x) + "x" + std::to_string(size.y);
+        std::string dims = std::to_string(width) + "x" + std::to_string(height);
+        cout << std::left << std::setw(28) << path << std::setw(13) << sourceDims << std::setw(13) << dims
+            << std::right << std::setw(7) << before / 1024 << " -> " << std::setw(5) << after / 1024
+            << std::setw(8) << static_cast<long long>(a.tellg()) / 1024 << " -> "
+            << static_cast<long long>(b.tellg()) / 1024 << "\n";
+    }
+    cout << "texture memory: " << totalBefore / 1024 << " KiB -> " << totalAfter / 1024
+        << " KiB (saved " << (totalBefore - totalAfter) / 1024 << " KiB)\n";
+    return true;
+}
+
+// Every file the game loads through ResourceCache: images pre-decoded, fonts as
+// raw bytes. Gameplay sprites are packed under the processed path they resolve
+// to, and atlas pages are included when an offline atlas exists.
+bool packArchive() {
+    ResourceCache& cache = ResourceCache::instance();
+    std::vector<std::string> images;
+    for (const auto& path : startupImagePaths())
+        images.push_back(cache.resolvePath(path));
+    for (const auto& path : screenImagePaths())
+        images.push_back(path);
+
+    ifstream atlasManifest("assets/atlas.txt");
+    size_t pages = 0;
+    if (atlasManifest >> pages) {
+        for (size_t p = 0; p < pages; ++p)
+            images.push_back("assets/atlas" + std::to_string(p) + ".png");
     }
 
+    std::vector<std::string> blobs = { "assets/Orbitron-Regular.ttf", "assets/impact.ttf" };
 
-    void render() {
+    sf::Clock clock;
+    if (!AssetArchive::write("assets/assets.pak", images, blobs))
+        return false;
+
+    AssetArchive check;
+    if (!check.open("assets/assets.pak"))
+        return false;
+    ifstream size("assets/assets.pak", ios::binary | ios::ate);
+    cout << "packed " << check.getEntryCount() << " assets into assets/assets.pak ("
+        << static_cast<long long>(size.tellg()) / 1024 << " KiB) in "
+        << clock.getElapsedTime().asMilliseconds() << " ms\n";
+    return true;
+}
 
-        window.clear();
-        player.draw(window);
-        const auto& topScores = highScoreManager.getScores();
-        for (size_t i = 0; i < 3 && i < topScores.size(); ++i) {
-            sf::Text badgeText;
-            badgeText.setFont(font);
-            badgeText.setCharacterSize(16);
-            badgeText.setFillColor(sf::Color::White);
-            badgeText.setString(topScores[i].getName() + ": " + topScores[i].getBadge());
-            badgeText.setPosition(10.f, 40.f + i * 20.f);
-            window.draw(badgeText);
-        }
+//---------------------------------- Main ----------------------------------
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench-broadphase") {
+        runBroadphaseBenchmark();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-collide") {
+        runCollideBenchmark();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--process-assets") {
+        return processAssets() ? 0 : 1;
+    }
 
-        for (auto& b : bullets)
-            b.draw(window);
-        for (auto* e : invaders) e->draw(window);
-        for (auto& exp : explosions) {
-            if (!exp.isFinished())
-                exp.draw(window);
-        }
-        for (auto* a : addons) a->draw(window);
-        for (auto& bomb : bombs) bomb.draw(window);
-        window.draw(scoreText);
-        window.draw(livesText);
-        if (gameStarting && gameStartClock.getElapsedTime().asSeconds() < 2.f) {
-            sf::Text startingText;
-            startingText.setFont(font);
-            startingText.setCharacterSize(28);
-            startingText.setFillColor(sf::Color::Yellow);
-            startingText.setString("GAME STARTING...");
-            startingText.setPosition(250, 250);
-            window.draw(startingText);
-        }
-        else {
-            gameStarting = false;
-        }
-        levelManager.updateDisplay(window);
+    // Processed sizes affect sprite bounds, so every mode below loads them.
+    ResourceCache::instance().loadProcessedAssets();
 
-        if (showWaveText && waveTextClock.getElapsedTime().asSeconds() < 2.f) {
-            window.draw(waveText);
-        }
-        else {
-            showWaveText = false;
-        }
-        if (monsterActive && monster) {
-            monster->draw(window);
-        }
-        if (showMonsterWarning) {
-            sf::Text warningText;
-            warningText.setFont(font);
-            warningText.setCharacterSize(30);
-            warningText.setFillColor(sf::Color::Red);
-            warningText.setOutlineColor(sf::Color::Black);
-            warningText.setOutlineThickness(2);
-            warningText.setString("MONSTER APPROACHING");
-            warningText.setPosition(200, 210);
-            window.draw(warningText);
-        }
-        if (showMonsterMessage && monsterMessageClock.getElapsedTime().asSeconds() <= 2.f) {
-            window.draw(monsterMessage);
-        }
-        else {
-            showMonsterMessage = false;
-        }
+    if (argc > 1 && std::string(argv[1]) == "--pack-archive") {
+        return packArchive() ? 0 : 1;
+    }
+    ResourceCache::instance().openArchive();
 
-        window.display();
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        long ticks = argc > 2 ? std::atol(argv[2]) : 100000;
+        unsigned seed = argc > 3 ? static_cast<unsigned>(std::atol(argv[3])) : 1;
+        runHeadless(ticks, seed);
+        return 0;
     }
-};
 
-//---------------------------------- Main ----------------------------------
-int main() {
-    Game game;
+    if (argc > 2 && std::string(argv[1]) == "--replay") {
+        return runReplay(argv[2]) ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--pack-atlas") {
+        TextureAtlas atlas;
+        atlas.pack(ResourceCache::instance().atlasSources(), ResourceCache::instance().getArchive());
+        if (!atlas.save("assets/atlas"))
+            return 1;
+        cout << "packed " << atlas.getRegionCount() << " images onto "
+            << atlas.getPageCount() << " page(s): assets/atlas.txt\n";
+        return 0;
+    }
+
+    ResourceCache::instance().loadAtlas();
+
+    Game game(argc > 2 && std::string(argv[1]) == "--record" ? argv[2] : "");
     game.start();
+    game.report(cout);
+    ResourceCache::instance().report(cout);
     return 0;
 }
\ No newline at end of file